@@ -0,0 +1,79 @@
+/*
+ * BackgroundLayer.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "BackgroundLayer.h"
+#include "AppConsts.h"
+
+#include <ofGraphics.h>
+
+#include <ciso646>
+
+#include <cmath>
+
+static const ofColor BACKGROUND_TINT { 240 };
+
+ofVec2f BackgroundLayer::slabSize(float zoom) const
+{
+    return ofVec2f(concrete->getWidth(), concrete->getHeight()) * (BG_SCALE * zoom);
+}
+
+void BackgroundLayer::refresh(const ViewCoords &view, const ofVec2f &viewSize)
+{
+    if (not concrete or not concrete->isAllocated()) {
+        layer.clear();
+        return;
+    }
+    if (layer.isAllocated() and view.zoom == zoom and viewSize == this->viewSize)
+        return;
+    zoom = view.zoom;
+    this->viewSize = viewSize;
+
+    // one slab more than the view in each direction, for any offset
+    const auto slab = slabSize(zoom);
+    const int cols = (int) std::ceil(viewSize.x / slab.x) + 1;
+    const int rows = (int) std::ceil(viewSize.y / slab.y) + 1;
+    // and a pixel for rounding the position in draw
+    const int width = (int) std::ceil(cols * slab.x) + 1;
+    const int height = (int) std::ceil(rows * slab.y) + 1;
+    if (not layer.isAllocated() or layer.getWidth() != width or layer.getHeight() != height) {
+        layer.clear();
+        layer.allocate(width, height, GL_RGB);
+    }
+
+    ofPushStyle();
+    layer.begin();
+    ofDisableAlphaBlending();
+    ofSetColor(BACKGROUND_TINT);
+    for (int row = 0; row < rows; ++row)
+        for (int col = 0; col < cols; ++col)
+            concrete->draw(col * slab.x, row * slab.y, slab.x, slab.y);
+    layer.end();
+    ofPopStyle();
+}
+
+void BackgroundLayer::draw(const ViewCoords &view) const
+{
+    if (not layer.isAllocated()) {
+        ofBackgroundGradient(ofColor { 120, 120, 120 }, ofColor { 160, 160, 160 });
+        return;
+    }
+
+    // the corner of a slab left of and above the view, whole pixels keep it sharp
+    const auto slab = slabSize(view.zoom);
+    float x = std::fmod(-view.offset.x * view.zoom, slab.x);
+    if (x > 0)
+        x -= slab.x;
+    float y = std::fmod(-view.offset.y * view.zoom, slab.y);
+    if (y > 0)
+        y -= slab.y;
+
+    ofPushStyle();
+    ofDisableAlphaBlending();
+    ofSetColor(255);
+    layer.draw(std::round(x), std::round(y));
+    ofPopStyle();
+}
@@ -0,0 +1,45 @@
+/*
+ * BackgroundLayer.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_BACKGROUNDLAYER_H_
+#define SRC_BACKGROUNDLAYER_H_
+
+#include "ViewCoords.h"
+
+#include <ofFbo.h>
+#include <ofImage.h>
+
+// The concrete floor under the tiles, tiled once into a frame buffer a slab
+// larger than the view and drawn as a single quad.
+// Panning only moves the layer by the view offset modulo the slab size;
+// it is tiled again only when the zoom or the size of the view changes.
+class BackgroundLayer
+{
+public:
+    void setImage(const ofImage *image)
+    {
+        concrete = image;
+        layer.clear();
+    }
+
+    // tiles the layer again if the view changed size or zoom;
+    // must not be called while drawing into a frame buffer
+    void refresh(const ViewCoords &view, const ofVec2f &viewSize);
+
+    // draws the layer, in window coordinates
+    void draw(const ViewCoords &view) const;
+
+private:
+    ofVec2f slabSize(float zoom) const;
+
+    const ofImage *concrete = nullptr;
+    ofFbo layer;
+    float zoom = 0;
+    ofVec2f viewSize;
+};
+
+#endif /* SRC_BACKGROUNDLAYER_H_ */
@@ -0,0 +1,136 @@
+/*
+ * ChunkCache.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "ChunkCache.h"
+
+#include <ciso646>
+
+ChunkCache::ChunkCache(size_t memoryLimit) :
+    memoryLimit(memoryLimit)
+{
+}
+
+ChunkCache::~ChunkCache()
+{
+    if (file != nullptr)
+        std::fclose(file);
+}
+
+void ChunkCache::put(const ChunkCoord &coord, const ChunkData &data)
+{
+    const auto found = spilled.find(coord);
+    if (found != spilled.end()) {
+        freeOffsets.push_back(found->second);
+        spilled.erase(found);
+    }
+
+    const auto inMemory = memory.find(coord);
+    if (inMemory != memory.end()) {
+        inMemory->second.data = data;
+        ages.splice(ages.end(), ages, inMemory->second.age);
+    } else {
+        memory.emplace(coord, Entry { data, ages.insert(ages.end(), coord) });
+    }
+
+    if (memory.size() > memoryLimit)
+        spillOldest();
+}
+
+ChunkCache::Found ChunkCache::take(const ChunkCoord &coord, ChunkData &data)
+{
+    const auto inMemory = memory.find(coord);
+    if (inMemory != memory.end()) {
+        data = inMemory->second.data;
+        ages.erase(inMemory->second.age);
+        memory.erase(inMemory);
+        return Found::Chunk;
+    }
+
+    const auto found = spilled.find(coord);
+    if (found == spilled.end())
+        return Found::Nothing;
+    const bool ok = read(found->second, data);
+    freeOffsets.push_back(found->second);
+    spilled.erase(found);
+    return ok ? Found::Chunk : Found::Unreadable;
+}
+
+void ChunkCache::erase(const ChunkCoord &coord)
+{
+    const auto inMemory = memory.find(coord);
+    if (inMemory != memory.end()) {
+        ages.erase(inMemory->second.age);
+        memory.erase(inMemory);
+    }
+    const auto found = spilled.find(coord);
+    if (found != spilled.end()) {
+        freeOffsets.push_back(found->second);
+        spilled.erase(found);
+    }
+}
+
+void ChunkCache::clear()
+{
+    memory.clear();
+    ages.clear();
+    spilled.clear();
+    freeOffsets.clear();
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    fileSize = 0;
+}
+
+void ChunkCache::spillOldest()
+{
+    if (file == nullptr) {
+        file = std::tmpfile();
+        // without a file the cache just grows
+        if (file == nullptr)
+            return;
+    }
+
+    const auto coord = ages.front();
+    auto &entry = memory.at(coord);
+
+    // the slot is only taken once the chunk is in it,
+    // so that failed writes on a full disk do not use up the file
+    const bool grow = freeOffsets.empty();
+    const std::uint64_t offset = grow ? fileSize : freeOffsets.back();
+    if (not write(offset, entry.data))
+        return;
+    if (grow)
+        fileSize += entry.data.size();
+    else
+        freeOffsets.pop_back();
+
+    spilled.emplace(coord, offset);
+    ages.pop_front();
+    memory.erase(coord);
+}
+
+bool ChunkCache::seek(std::uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64) offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t) offset, SEEK_SET) == 0;
+#endif
+}
+
+bool ChunkCache::read(std::uint64_t offset, ChunkData &data)
+{
+    return seek(offset)
+        and std::fread(data.data(), 1, data.size(), file) == data.size();
+}
+
+bool ChunkCache::write(std::uint64_t offset, const ChunkData &data)
+{
+    return seek(offset)
+        and std::fwrite(data.data(), 1, data.size(), file) == data.size();
+}
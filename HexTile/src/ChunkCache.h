@@ -0,0 +1,131 @@
+/*
+ * ChunkCache.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_CHUNKCACHE_H_
+#define SRC_CHUNKCACHE_H_
+
+#include "TileChunk.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Packed state of chunks that were edited and then left far behind by the view.
+// The chunks put last are kept in memory, up to memoryLimit of them;
+// older ones are moved to a temporary file and read back when taken.
+class ChunkCache
+{
+public:
+    enum class Found
+    {
+        Nothing,
+        Chunk,
+        // the chunk was spilled and cannot be read back; it is dropped with its edits
+        Unreadable,
+    };
+
+    explicit ChunkCache(size_t memoryLimit);
+    ~ChunkCache();
+
+    ChunkCache(const ChunkCache &) = delete;
+    ChunkCache &operator =(const ChunkCache &) = delete;
+
+    void put(const ChunkCoord &coord, const ChunkData &data);
+
+    // moves the chunk out of the cache
+    Found take(const ChunkCoord &coord, ChunkData &data);
+
+    bool contains(const ChunkCoord &coord) const
+    {
+        return memory.count(coord) != 0 || spilled.count(coord) != 0;
+    }
+
+    void erase(const ChunkCoord &coord);
+    void clear();
+
+    size_t size() const
+    {
+        return memory.size() + spilled.size();
+    }
+
+    // f(coord, data) for every chunk, the spilled ones read back one by one;
+    // returns false if some of them cannot be read back, lost(coord) is called for those
+    template <typename F, typename L>
+    bool forEach(F f, L lost)
+    {
+        for (const auto &entry : memory)
+            f(entry.first, entry.second.data);
+        bool complete = true;
+        ChunkData data;
+        for (const auto &entry : spilled) {
+            if (read(entry.second, data)) {
+                f(entry.first, data);
+            } else {
+                lost(entry.first);
+                complete = false;
+            }
+        }
+        return complete;
+    }
+
+    template <typename F>
+    bool forEach(F f)
+    {
+        return forEach(f, [](const ChunkCoord &) {});
+    }
+
+    // f(coord, data) for every chunk, changing it in place; the spilled ones are
+    // read and written back one by one, lost(coord) is called for those that
+    // cannot be and they are dropped
+    template <typename F, typename L>
+    void update(F f, L lost)
+    {
+        for (auto &entry : memory)
+            f(entry.first, entry.second.data);
+        ChunkData data;
+        for (auto entry = spilled.begin(); entry != spilled.end();) {
+            if (read(entry->second, data)) {
+                f(entry->first, data);
+                if (write(entry->second, data)) {
+                    ++entry;
+                    continue;
+                }
+            }
+            lost(entry->first);
+            freeOffsets.push_back(entry->second);
+            entry = spilled.erase(entry);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        ChunkData data;
+        std::list<ChunkCoord>::iterator age;
+    };
+
+    void spillOldest();
+    // 64 bit offsets, the file may grow past what a long holds
+    bool seek(std::uint64_t offset);
+    bool read(std::uint64_t offset, ChunkData &data);
+    bool write(std::uint64_t offset, const ChunkData &data);
+
+    size_t memoryLimit;
+
+    std::unordered_map<ChunkCoord, Entry> memory;
+    // oldest first
+    std::list<ChunkCoord> ages;
+
+    std::FILE *file = nullptr;
+    std::unordered_map<ChunkCoord, std::uint64_t> spilled;
+    std::vector<std::uint64_t> freeOffsets;
+    std::uint64_t fileSize = 0;
+};
+
+#endif /* SRC_CHUNKCACHE_H_ */
@@ -0,0 +1,137 @@
+/*
+ * ChunkImages.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "ChunkImages.h"
+#include "TileParams.h"
+
+#include <ofGraphics.h>
+
+#include <ciso646>
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr float CHUNK_WIDTH = CHUNK_COLS * TileParams::col_width;
+static constexpr float CHUNK_HEIGHT = CHUNK_ROWS * TileParams::row_height;
+
+ofRectangle ChunkImages::area(const ChunkCoord &chunk)
+{
+    return ofRectangle(chunk.col * CHUNK_WIDTH, chunk.row * CHUNK_HEIGHT, CHUNK_WIDTH, CHUNK_HEIGHT);
+}
+
+template <typename F>
+void ChunkImages::forEachChunk(const ofRectangle &rect, F f)
+{
+    const int firstCol = (int) std::floor(rect.x / CHUNK_WIDTH);
+    const int lastCol = (int) std::floor((rect.x + rect.width) / CHUNK_WIDTH);
+    const int firstRow = (int) std::floor(rect.y / CHUNK_HEIGHT);
+    const int lastRow = (int) std::floor((rect.y + rect.height) / CHUNK_HEIGHT);
+
+    for (int row = firstRow; row <= lastRow; ++row)
+        for (int col = firstCol; col <= lastCol; ++col)
+            f(ChunkCoord { row, col });
+}
+
+void ChunkImages::markDirty(const TileView &tv)
+{
+    const auto &tiles = tv.tiles;
+    const auto mark = [this, &tiles](TileId id) {
+        forEachChunk(TileParams::drawn_box(tiles.coord(id)), [this](const ChunkCoord &chunk) {
+            const auto image = cache.find(chunk);
+            if (image != cache.end())
+                image->second.dirty = true;
+        });
+    };
+
+    if (not tiles.forEachEditSince(seenEdits, mark)) {
+        for (auto &image : cache)
+            image.second.dirty = true;
+    }
+    seenEdits = tiles.editCount();
+    tiles.forEachInTransition(mark);
+}
+
+void ChunkImages::refresh(const TileView &tv)
+{
+    ++frame;
+    markDirty(tv);
+
+    forEachChunk(tv.view.getViewRect(tv.viewSize), [this, &tv](const ChunkCoord &chunk) {
+        auto &image = cache[chunk];
+        image.lastUsed = frame;
+        if (image.dirty)
+            render(tv, chunk, image);
+    });
+
+    dropUnused();
+}
+
+void ChunkImages::render(const TileView &tv, const ChunkCoord &chunk, Image &image)
+{
+    const auto rect = area(chunk);
+
+    if (not image.fbo.isAllocated())
+        image.fbo.allocate((int) std::ceil(rect.width * SCALE), (int) std::ceil(rect.height * SCALE), GL_RGBA);
+
+    tv.findTiles(rect, found);
+    batch.build(tv.tiles, found);
+
+    ofPushStyle();
+    image.fbo.begin();
+    ofClear(0, 0, 0, 0);
+
+    ofEnableSmoothing();
+    ofEnableAntiAliasing();
+    ofEnableAlphaBlending();
+
+    ofPushMatrix();
+    ofScale(SCALE, SCALE);
+    ofTranslate(-rect.x, -rect.y);
+    batch.draw(SCALE);
+    ofPopMatrix();
+
+    image.fbo.end();
+    ofPopStyle();
+
+    image.dirty = false;
+}
+
+void ChunkImages::dropUnused()
+{
+    if (cache.size() <= MAX_IMAGES)
+        return;
+
+    std::vector<std::uint64_t> ages;
+    ages.reserve(cache.size());
+    for (const auto &image : cache)
+        ages.push_back(image.second.lastUsed);
+    // keep the MAX_IMAGES used last, and everything used in this frame
+    std::nth_element(ages.begin(), ages.end() - MAX_IMAGES, ages.end());
+    const auto oldest = std::min(ages[ages.size() - MAX_IMAGES], frame);
+
+    for (auto image = cache.begin(); image != cache.end();) {
+        if (image->second.lastUsed < oldest)
+            image = cache.erase(image);
+        else
+            ++image;
+    }
+}
+
+void ChunkImages::draw(const TileView &tv) const
+{
+    ofPushStyle();
+    ofEnableAlphaBlending();
+    ofSetColor(255);
+    forEachChunk(tv.view.getViewRect(tv.viewSize), [this](const ChunkCoord &chunk) {
+        const auto image = cache.find(chunk);
+        if (image != cache.end() and image->second.fbo.isAllocated()) {
+            const auto rect = area(chunk);
+            image->second.fbo.draw(rect.x, rect.y, rect.width, rect.height);
+        }
+    });
+    ofPopStyle();
+}
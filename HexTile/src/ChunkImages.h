@@ -0,0 +1,82 @@
+/*
+ * ChunkImages.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_CHUNKIMAGES_H_
+#define SRC_CHUNKIMAGES_H_
+
+#include "TileBatch.h"
+#include "TileChunk.h"
+#include "TileView.h"
+
+#include <ofFbo.h>
+#include <ofRectangle.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Level of detail for views zoomed out so far that the tiles are only a few pixels wide.
+// The tiles of each chunk are drawn once into an image, which is then drawn
+// as a single quad until a tile touching the chunk changes,
+// so drawing takes the same time however many tiles there are in the view.
+// The images cover the area of the view coordinates taken by their chunk,
+// including the parts of neighbouring tiles reaching into it.
+class ChunkImages
+{
+public:
+    // used when the view is zoomed out to ZOOM_LIMIT or further
+    static constexpr float ZOOM_LIMIT = 0.25f;
+    // texels per unit of view coordinates; at least one texel per pixel
+    // at every zoom the images are used at, so they are never magnified
+    static constexpr float SCALE = ZOOM_LIMIT;
+    // images not drawn lately are dropped beyond this count
+    static constexpr size_t MAX_IMAGES = 32;
+
+    static bool isUsedAt(float zoom)
+    {
+        return zoom <= ZOOM_LIMIT;
+    }
+
+    void setImages(TileImages *tileImages)
+    {
+        batch.setImages(tileImages);
+        cache.clear();
+    }
+
+    // redraws the images of the chunks in the view that changed since they were drawn;
+    // must not be called while drawing into a frame buffer
+    void refresh(const TileView &tv);
+
+    // draws the images of the chunks in the view, in view coordinates
+    void draw(const TileView &tv) const;
+
+private:
+    struct Image
+    {
+        ofFbo fbo;
+        bool dirty = true;
+        std::uint64_t lastUsed = 0;
+    };
+
+    static ofRectangle area(const ChunkCoord &chunk);
+    template <typename F>
+    static void forEachChunk(const ofRectangle &rect, F f);
+
+    void markDirty(const TileView &tv);
+    void render(const TileView &tv, const ChunkCoord &chunk, Image &image);
+    void dropUnused();
+
+    std::unordered_map<ChunkCoord, Image> cache;
+
+    TileBatch batch;
+    std::vector<TileId> found;
+
+    std::uint64_t seenEdits = 0;
+    std::uint64_t frame = 0;
+};
+
+#endif /* SRC_CHUNKIMAGES_H_ */
@@ -0,0 +1,106 @@
+/*
+ * ChunkPrefetch.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "ChunkPrefetch.h"
+
+#include <ciso646>
+
+#include <algorithm>
+#include <chrono>
+
+// the main thread does not wake the thread when it empties a slot
+static constexpr std::chrono::milliseconds FULL_RING_POLL { 5 };
+
+ChunkPrefetch::~ChunkPrefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void ChunkPrefetch::request(const FloorFile &floor, FloorPattern pattern, std::vector<ChunkCoord> chunks)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->floor = &floor;
+        this->pattern = pattern;
+        wanted = std::move(chunks);
+    }
+    if (not thread.joinable() and not wanted.empty())
+        thread = std::thread([this] { run(); });
+    wake.notify_all();
+}
+
+void ChunkPrefetch::cancel()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    wanted.clear();
+    floor = nullptr;
+    idle.wait(lock, [this] { return not busy; });
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+bool ChunkPrefetch::take(ChunkCoord &coord, ChunkData &data)
+{
+    const auto index = tail.load(std::memory_order_relaxed);
+    if (index == head.load(std::memory_order_acquire))
+        return false;
+    const auto &slot = slots[index % SLOTS];
+    coord = slot.coord;
+    data = slot.data;
+    tail.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+void ChunkPrefetch::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        busy = false;
+        idle.notify_all();
+
+        const auto ready = [this] {
+            return stopping or (not wanted.empty()
+                                and head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) < SLOTS);
+        };
+        while (not ready()) {
+            if (wanted.empty())
+                wake.wait(lock);
+            else
+                wake.wait_for(lock, FULL_RING_POLL);
+        }
+        if (stopping)
+            return;
+
+        const auto coord = wanted.back();
+        wanted.pop_back();
+        const auto *floor = this->floor;
+        const auto pattern = this->pattern;
+        busy = true;
+        lock.unlock();
+
+        const auto index = head.load(std::memory_order_relaxed);
+        auto &slot = slots[index % SLOTS];
+        bool found = true;
+        if (const auto *saved = floor->find(coord))
+            std::copy(saved, saved + ChunkBits::SIZE, slot.data.begin());
+        else if (not pattern.isNone())
+            pattern.fill(coord, slot.data);
+        else
+            found = false;
+        if (found) {
+            slot.coord = coord;
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        lock.lock();
+    }
+}
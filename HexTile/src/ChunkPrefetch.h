@@ -0,0 +1,79 @@
+/*
+ * ChunkPrefetch.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_CHUNKPREFETCH_H_
+#define SRC_CHUNKPREFETCH_H_
+
+#include "FloorFile.h"
+#include "FloorPattern.h"
+#include "TileChunk.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reads the chunks the view is heading for on a thread of its own.
+// The saved chunks are read from the floor file, paging it in, and the
+// others are filled in from the pattern, so the main thread only has to
+// insert their tiles when it gets there.
+// Read chunks are handed over through a ring of SLOTS slots with atomic
+// indices: taking them never waits for the thread. The thread waits while
+// the ring is full.
+class ChunkPrefetch
+{
+public:
+    static constexpr size_t SLOTS = 16;
+
+    ChunkPrefetch() = default;
+    ~ChunkPrefetch();
+
+    ChunkPrefetch(const ChunkPrefetch &) = delete;
+    ChunkPrefetch &operator =(const ChunkPrefetch &) = delete;
+
+    // replaces the chunks to be read, the last one is read first;
+    // floor must not be closed or reopened before cancel is called
+    void request(const FloorFile &floor, FloorPattern pattern, std::vector<ChunkCoord> chunks);
+
+    // forgets the requested and the read chunks,
+    // and waits until the thread is done with the floor
+    void cancel();
+
+    // a chunk read since, false if there is none;
+    // chunks that are neither saved nor patterned are left out
+    bool take(ChunkCoord &coord, ChunkData &data);
+
+private:
+    struct Slot
+    {
+        ChunkCoord coord;
+        ChunkData data;
+    };
+
+    void run();
+
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    // guarded by mutex
+    std::vector<ChunkCoord> wanted;
+    const FloorFile *floor = nullptr;
+    FloorPattern pattern;
+    bool busy = false;
+    bool stopping = false;
+
+    std::array<Slot, SLOTS> slots;
+    // slots are written at head by the thread and read at tail by the main thread
+    std::atomic<size_t> head { 0 };
+    std::atomic<size_t> tail { 0 };
+};
+
+#endif /* SRC_CHUNKPREFETCH_H_ */
@@ -0,0 +1,323 @@
+/*
+ * Crowd.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "Crowd.h"
+#include "Sticky.h"
+#include "TileParams.h"
+#include "WorkerPool.h"
+
+#include <ofGraphics.h>
+
+#include <ciso646>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+// the part of the sprite below the feet, as drawn by Sticky
+static constexpr float FEET = 0.125f;
+static constexpr unsigned QUAD_VERTICES = 4;
+
+constexpr std::chrono::milliseconds Crowd::MAX_STEP;
+
+static bool isWalkable(const TileView &tv, const TileCoord &coord)
+{
+    const auto id = tv.findTile(coord);
+    return id != NO_TILE and (tv.tiles.isEnabled(id) or tv.tiles.isInTransition(id));
+}
+
+// Direction across the face of the cube on the tile that holds the point:
+// the face with the vertex d nearest to it, as Sticky::adjustDirection picks it,
+// crossed at right angles to the line from the centre to d.
+// False for tiles without a cube.
+static bool faceAxis(const TileStore &tiles, TileId id, float x, float y, float &ax, float &ay)
+{
+    const auto orientation = tiles.orientation(id);
+    if (orientation == Orientation::Blank)
+        return false;
+
+    const auto center = TileParams::center(tiles.coord(id));
+    x -= center.x;
+    y -= center.y;
+
+    int nearest = -1;
+    float nearestDistance = 0;
+    for (int i = orientation == Orientation::Even ? 1 : 0; i < 6; i += 2) {
+        const float vx = TileParams::vertex_x[i] - x;
+        const float vy = TileParams::vertex_y[i] - y;
+        const float distance = vx * vx + vy * vy;
+        if (nearest < 0 or distance < nearestDistance) {
+            nearest = i;
+            nearestDistance = distance;
+        }
+    }
+    ax = -TileParams::vertex_y[nearest] / TileParams::radius;
+    ay = TileParams::vertex_x[nearest] / TileParams::radius;
+    return true;
+}
+
+size_t Crowd::populate(const TileView &tv, size_t count, unsigned seed)
+{
+    const auto rect = tv.view.getViewRect(tv.viewSize);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> px(rect.x, rect.x + rect.width);
+    std::uniform_real_distribution<float> py(rect.y, rect.y + rect.height);
+    std::uniform_real_distribution<float> angle(0, 2 * M_PI);
+    std::uniform_int_distribution<unsigned> step(0, 255);
+
+    size_t added = 0;
+    // a floor with few tiles in the view gets fewer walkers
+    for (size_t attempt = 0; attempt < 16 * count and added < count; ++attempt) {
+        const float wx = px(random);
+        const float wy = py(random);
+        if (not isWalkable(tv, TileParams::coord_at(wx, wy)))
+            continue;
+        const float a = angle(random);
+        x.push_back(wx);
+        y.push_back(wy);
+        dx.push_back(std::cos(a));
+        dy.push_back(std::sin(a));
+        phase.push_back((std::uint8_t) step(random));
+        ++added;
+    }
+
+    const auto walkers = x.size();
+    nextDx.resize(walkers);
+    nextDy.resize(walkers);
+    onFace.resize(walkers);
+    tile.resize(walkers);
+    bucket.resize(walkers);
+    return added;
+}
+
+void Crowd::clear()
+{
+    for (auto *values : { &x, &y, &dx, &dy, &nextDx, &nextDy })
+        values->clear();
+    onFace.clear();
+    phase.clear();
+    tile.clear();
+    bucket.clear();
+    bucketStart.clear();
+    byBucket.clear();
+    for (auto &mesh : sprites)
+        mesh.clear();
+    started = false;
+}
+
+void Crowd::hashWalkers(size_t begin, size_t end)
+{
+    const auto mask = (std::uint32_t) bucketStart.size() - 2;
+    const std::hash<TileCoord> hash;
+    for (size_t i = begin; i < end; ++i) {
+        tile[i] = TileParams::coord_at(x[i], y[i]);
+        bucket[i] = (std::uint32_t) hash(tile[i]) & mask;
+    }
+}
+
+// counting sort of the walkers by bucket
+void Crowd::sortWalkers()
+{
+    std::fill(bucketStart.begin(), bucketStart.end(), 0);
+    for (auto b : bucket)
+        ++bucketStart[b + 1];
+    for (size_t b = 1; b < bucketStart.size(); ++b)
+        bucketStart[b] += bucketStart[b - 1];
+
+    byBucket.resize(size());
+    // the starts move by one bucket while filling and are back in place at the end
+    for (std::uint32_t i = 0; i < size(); ++i)
+        byBucket[bucketStart[bucket[i]]++] = i;
+    for (size_t b = bucketStart.size() - 1; b > 0; --b)
+        bucketStart[b] = bucketStart[b - 1];
+    bucketStart[0] = 0;
+}
+
+void Crowd::steer(const TileView &tv, float step, size_t begin, size_t end)
+{
+    const auto mask = (std::uint32_t) bucketStart.size() - 2;
+    const std::hash<TileCoord> hash;
+
+    for (size_t i = begin; i < end; ++i) {
+        float hx = dx[i];
+        float hy = dy[i];
+
+        const auto id = tv.findTile(tile[i]);
+        const bool walkable = id != NO_TILE and (tv.tiles.isEnabled(id) or tv.tiles.isInTransition(id));
+        float ax, ay;
+        onFace[i] = walkable and faceAxis(tv.tiles, id, x[i], y[i], ax, ay);
+        if (onFace[i]) {
+            const float sense = ax * hx + ay * hy < 0 ? -1.f : 1.f;
+            hx = sense * ax;
+            hy = sense * ay;
+        }
+
+        // walkers too close push the walker away, the closer the harder
+        float px = 0, py = 0;
+        unsigned looked = 0;
+        std::uint32_t seen[7];
+        unsigned seenCount = 0;
+        const auto neighbours = tile[i].neighbours();
+        for (unsigned n = 0; n < 7 and looked < MAX_NEIGHBOURS; ++n) {
+            const auto b = (std::uint32_t) hash(n == 0 ? tile[i] : neighbours[n - 1]) & mask;
+            if (std::find(seen, seen + seenCount, b) != seen + seenCount)
+                continue;
+            seen[seenCount++] = b;
+            for (auto k = bucketStart[b]; k < bucketStart[b + 1] and looked < MAX_NEIGHBOURS; ++k) {
+                const auto j = byBucket[k];
+                if (j == i)
+                    continue;
+                ++looked;
+                const float ox = x[i] - x[j];
+                const float oy = y[i] - y[j];
+                const float distance2 = ox * ox + oy * oy;
+                if (distance2 >= SPACING * SPACING or distance2 == 0)
+                    continue;
+                const float distance = std::sqrt(distance2);
+                const float push = (SPACING - distance) / (SPACING * distance);
+                px += ox * push;
+                py += oy * push;
+            }
+        }
+        hx += px;
+        hy += py;
+        const float length = std::sqrt(hx * hx + hy * hy);
+        if (length > 0) {
+            hx /= length;
+            hy /= length;
+        } else {
+            hx = dx[i];
+            hy = dy[i];
+        }
+
+        // turns back rather than stepping off the floor
+        if (walkable and not isWalkable(tv, TileParams::coord_at(x[i] + hx * step, y[i] + hy * step))) {
+            hx = -dx[i];
+            hy = -dy[i];
+        }
+        nextDx[i] = hx;
+        nextDy[i] = hy;
+    }
+}
+
+// plain loops over the arrays, which the compiler turns into vector instructions
+void Crowd::walk(float step, size_t begin, size_t end)
+{
+    float *const px = x.data();
+    float *const py = y.data();
+    float *const hx = dx.data();
+    float *const hy = dy.data();
+    const float *const nx = nextDx.data();
+    const float *const ny = nextDy.data();
+    for (size_t i = begin; i < end; ++i) {
+        hx[i] = nx[i];
+        hy[i] = ny[i];
+    }
+    for (size_t i = begin; i < end; ++i) {
+        px[i] += hx[i] * step;
+        py[i] += hy[i] * step;
+    }
+}
+
+void Crowd::update(const TileView &tv, const TimeStamp &now)
+{
+    const auto elapsed = started ? std::min<Duration>(now - lastUpdate, MAX_STEP) : Duration(0);
+    started = true;
+    lastUpdate = now;
+    if (empty())
+        return;
+    const float step = SPEED * FloatSeconds(elapsed).count();
+
+    // at least two buckets per walker
+    size_t buckets = 1;
+    while (buckets < 2 * size())
+        buckets *= 2;
+    bucketStart.resize(buckets + 1);
+
+    auto &pool = WorkerPool::shared();
+    pool.parallel_for(size(), SLICE, [this](size_t begin, size_t end) {
+        hashWalkers(begin, end);
+    });
+    sortWalkers();
+    pool.parallel_for(size(), SLICE, [this, &tv, step](size_t begin, size_t end) {
+        steer(tv, step, begin, end);
+    });
+    pool.parallel_for(size(), SLICE, [this, step](size_t begin, size_t end) {
+        walk(step, begin, end);
+    });
+
+    buildSprites(tv, now);
+}
+
+void Crowd::buildSprites(const TileView &tv, const TimeStamp &now)
+{
+    const auto imageCount = images != nullptr ? images->size() : 0;
+    sprites.resize(imageCount);
+    for (auto &mesh : sprites) {
+        mesh.clear();
+        mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+        mesh.setUsage(GL_STREAM_DRAW);
+    }
+    if (imageCount == 0 or not (*images)[0].isAllocated())
+        return;
+
+    static constexpr float sin_60_deg = TileParams::sin_60_deg;
+    const auto steps = (size_t) (now.time_since_epoch() / STEP_DURATION);
+    const float w = (*images)[0].getWidth() * PIX_PER_MM;
+    const float h = (*images)[0].getHeight() * PIX_PER_MM;
+    const float left = -w / 2, right = w / 2;
+    const float top = h * FEET - h, bottom = h * FEET;
+
+    auto rect = tv.view.getViewRect(tv.viewSize);
+    rect.x -= h;
+    rect.y -= h;
+    rect.width += 2 * h;
+    rect.height += 2 * h;
+
+    for (size_t i = 0; i < size(); ++i) {
+        if (not rect.inside(x[i], y[i]))
+            continue;
+        const auto image = (steps + phase[i]) % imageCount;
+        auto &mesh = sprites[image];
+        const auto texMax = (*images)[image].getTexture().getCoordFromPercent(1, 1);
+
+        // turned like Sticky::draw: upright off the cube faces,
+        // on a face with the head to the back of the heading
+        float c = 1, s = 0, scale = 1;
+        if (onFace[i]) {
+            c = -dx[i];
+            s = -dy[i];
+            scale = sin_60_deg;
+        }
+        const auto first = (unsigned) mesh.getNumVertices();
+        const float corners[QUAD_VERTICES][2] = { { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+        for (const auto &corner : corners) {
+            const float cx = corner[0] * scale;
+            const float cy = corner[1] * scale;
+            mesh.addVertex(ofVec3f(x[i] + cx * c - cy * s, y[i] + cx * s + cy * c));
+        }
+        mesh.addTexCoord(ofVec2f(0, 0));
+        mesh.addTexCoord(ofVec2f(texMax.x, 0));
+        mesh.addTexCoord(ofVec2f(texMax.x, texMax.y));
+        mesh.addTexCoord(ofVec2f(0, texMax.y));
+        for (unsigned k : { 0, 1, 2, 0, 2, 3 })
+            mesh.addIndex(first + k);
+    }
+}
+
+void Crowd::draw() const
+{
+    for (size_t image = 0; image < sprites.size(); ++image) {
+        if (sprites[image].getNumVertices() == 0)
+            continue;
+        const auto &texture = (*images)[image].getTexture();
+        texture.bind();
+        sprites[image].draw();
+        texture.unbind();
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Crowd.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_CROWD_H_
+#define SRC_CROWD_H_
+
+#include "AppConsts.h"
+#include "Clock.h"
+#include "TileCoord.h"
+#include "TileView.h"
+
+#include <ofImage.h>
+#include <ofVboMesh.h>
+
+#include <cstdint>
+#include <vector>
+
+// Sticky figures walking the floor on their own.
+// Like the Sticky following the mouse, a walker on a tile with a cube goes
+// across the face of the cube under it, keeping the sense it came with;
+// on blank tiles it goes straight on, and it turns back at the edge of the floor.
+// Walkers closer than SPACING push each other apart. They are hashed by the
+// tile they stand on, so each looks only at the walkers of its tile and the
+// six around it.
+// The walkers are kept as arrays of floats, one per component, and updated
+// by the worker pool in slices of SLICE walkers. The sprites are drawn with
+// one draw call per step image.
+class Crowd
+{
+public:
+    // view coordinates per second
+    static constexpr float SPEED = TILE_RADIUS_PIX;
+    static constexpr float SPACING = TILE_RADIUS_PIX / 3;
+    // walkers looked at by each walker to keep its distance
+    static constexpr unsigned MAX_NEIGHBOURS = 32;
+    static constexpr size_t SLICE = 1024;
+    // longer pauses between updates are not walked all at once
+    static constexpr std::chrono::milliseconds MAX_STEP { 100 };
+
+    // the step images of Sticky
+    void setImages(const std::vector<ofImage> *images)
+    {
+        this->images = images;
+    }
+
+    // adds up to count walkers on the visible tiles of the view, returns how many
+    size_t populate(const TileView &tv, size_t count, unsigned seed);
+    void clear();
+
+    size_t size() const
+    {
+        return x.size();
+    }
+    bool empty() const
+    {
+        return x.empty();
+    }
+
+    // walks the time since the last update and builds the sprites of the walkers in the view
+    void update(const TileView &tv, const TimeStamp &now);
+    // in view coordinates
+    void draw() const;
+
+private:
+    void hashWalkers(size_t begin, size_t end);
+    void sortWalkers();
+    void steer(const TileView &tv, float step, size_t begin, size_t end);
+    void walk(float step, size_t begin, size_t end);
+    void buildSprites(const TileView &tv, const TimeStamp &now);
+
+    const std::vector<ofImage> *images = nullptr;
+
+    // one entry per walker
+    std::vector<float> x, y;
+    // heading, of unit length
+    std::vector<float> dx, dy;
+    std::vector<float> nextDx, nextDy;
+    // walking across a cube face, drawn foreshortened
+    std::vector<std::uint8_t> onFace;
+    // offset of the step image, so that they do not walk in step
+    std::vector<std::uint8_t> phase;
+    // the tile under the walker and its bucket in the hash
+    std::vector<TileCoord> tile;
+    std::vector<std::uint32_t> bucket;
+
+    // walkers of bucket b are byBucket[bucketStart[b]] to byBucket[bucketStart[b + 1] - 1]
+    std::vector<std::uint32_t> bucketStart;
+    std::vector<std::uint32_t> byBucket;
+
+    // one mesh per step image
+    std::vector<ofVboMesh> sprites;
+
+    bool started = false;
+    TimeStamp lastUpdate;
+};
+
+#endif /* SRC_CROWD_H_ */
@@ -0,0 +1,77 @@
+/*
+ * DirtyRegion.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_DIRTYREGION_H_
+#define SRC_DIRTYREGION_H_
+
+#include <ofRectangle.h>
+
+#include <vector>
+
+// Parts of the frame buffer that have to be redrawn, as a few disjoint rectangles.
+// Overlapping rectangles are merged; past MAX_RECTS everything is merged
+// into one bounding rectangle.
+class DirtyRegion
+{
+public:
+    static constexpr size_t MAX_RECTS = 16;
+
+    void add(ofRectangle rect)
+    {
+        // growing a rectangle may make it overlap others, so merge until none do
+        for (size_t i = 0; i < rects.size();) {
+            if (overlap(rects[i], rect)) {
+                rect.growToInclude(rects[i]);
+                rects[i] = rects.back();
+                rects.pop_back();
+                i = 0;
+            } else {
+                ++i;
+            }
+        }
+        if (rects.size() == MAX_RECTS) {
+            for (const auto &other : rects)
+                rect.growToInclude(other);
+            rects.clear();
+        }
+        rects.push_back(rect);
+    }
+
+    void clear()
+    {
+        rects.clear();
+    }
+
+    bool empty() const
+    {
+        return rects.empty();
+    }
+
+    float area() const
+    {
+        float result = 0;
+        for (const auto &rect : rects)
+            result += rect.width * rect.height;
+        return result;
+    }
+
+    const std::vector<ofRectangle> &getRects() const
+    {
+        return rects;
+    }
+
+private:
+    static bool overlap(const ofRectangle &a, const ofRectangle &b)
+    {
+        return a.x <= b.x + b.width && b.x <= a.x + a.width
+            && a.y <= b.y + b.height && b.y <= a.y + a.height;
+    }
+
+    std::vector<ofRectangle> rects;
+};
+
+#endif /* SRC_DIRTYREGION_H_ */
@@ -0,0 +1,269 @@
+/*
+ * EditHistory.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "EditHistory.h"
+#include "TileView.h"
+
+#include <ciso646>
+
+#include <algorithm>
+
+static constexpr std::uint8_t ENABLED = 1 << 4;
+
+static unsigned colorOf(std::uint8_t state)
+{
+    return state >> 2 & 3;
+}
+
+static unsigned orientationOf(std::uint8_t state)
+{
+    return state & 3;
+}
+
+EditHistory::State EditHistory::state(const TileStore &tiles, TileId id)
+{
+    return State((tiles.isEnabled(id) ? ENABLED : 0)
+                 | (unsigned) tiles.color(id) << 2
+                 | (unsigned) tiles.orientation(id));
+}
+
+EditHistory::State EditHistory::transform(Bulk bulk, State state, bool inverse)
+{
+    const unsigned color = colorOf(state);
+    const unsigned orientation = orientationOf(state);
+    const State rest = state & ~(3 << 2);
+
+    switch (bulk) {
+    case Bulk::None:
+        break;
+    case Bulk::ColorUp:
+    case Bulk::ColorDown:
+        if ((bulk == Bulk::ColorUp) != inverse)
+            return State(rest | (color + 1) % 3 << 2);
+        return State(rest | (color + 2) % 3 << 2);
+    case Bulk::FlipOrientation:
+        if (orientation != 0)
+            return State((state & ~3) | (3 - orientation));
+        break;
+    case Bulk::Disable:
+        return State(inverse ? state | ENABLED : state & ~ENABLED);
+    }
+    return state;
+}
+
+void EditHistory::begin(const TileStore &tiles, const std::vector<TileId> &ids)
+{
+    before.clear();
+    for (auto id : ids)
+        before.push_back(Snapshot { id, state(tiles, id) });
+    bulk = Bulk::None;
+}
+
+void EditHistory::editFloor(TileView &tv, const TimeStamp &now, Bulk bulk)
+{
+    floor = tv.prepareFloorEdit(bulk);
+    before.clear();
+    // a disabled floor is restored from the chunks kept by prepareFloorEdit
+    if (bulk != Bulk::Disable)
+        tv.tiles.forEach([&](TileId id) {
+            before.push_back(Snapshot { id, state(tv.tiles, id) });
+        });
+    this->bulk = bulk;
+    tv.editFloor(now, bulk);
+    end(tv.tiles);
+}
+
+void EditHistory::floorSaved()
+{
+    // the saved floor has no tiles left of the ones disabled before
+    for (size_t i = done.size(); i-- > 0;) {
+        if (done[i].bulk != Bulk::Disable)
+            continue;
+        for (size_t j = 0; j <= i; ++j)
+            memory -= done[j].bytes();
+        done.erase(done.begin(), done.begin() + i + 1);
+        break;
+    }
+}
+
+void EditHistory::end(const TileStore &tiles)
+{
+    // a bulk operation in the middle of a stroke is a command of its own
+    const bool merge = inStroke and bulk == Bulk::None;
+
+    Command command;
+    command.bulk = bulk;
+    command.floor = std::move(floor);
+    floor = FloorUndo();
+    std::vector<TileCoord> bulkTiles;
+
+    for (const auto &snapshot : before) {
+        const auto after = state(tiles, snapshot.id);
+        if (after == snapshot.state)
+            continue;
+        const auto &coord = tiles.coord(snapshot.id);
+        if (bulk != Bulk::None and after == transform(bulk, snapshot.state, false)) {
+            bulkTiles.push_back(coord);
+        } else if (merge) {
+            const auto found = strokeTiles.find(coord);
+            if (found != strokeTiles.end()) {
+                stroke.deltas[found->second].after = after;
+            } else {
+                strokeTiles.emplace(coord, stroke.deltas.size());
+                stroke.deltas.push_back(Delta { coord, snapshot.state, after });
+            }
+        } else {
+            command.deltas.push_back(Delta { coord, snapshot.state, after });
+        }
+    }
+    before.clear();
+    bulk = Bulk::None;
+
+    if (merge)
+        return;
+
+    std::sort(bulkTiles.begin(), bulkTiles.end(), [](const TileCoord &a, const TileCoord &b) {
+        return a.row < b.row or (a.row == b.row and a.col < b.col);
+    });
+    for (const auto &coord : bulkTiles) {
+        if (not command.spans.empty()) {
+            auto &last = command.spans.back();
+            if (last.row == coord.row and last.col + (std::int32_t) last.count == coord.col) {
+                ++last.count;
+                continue;
+            }
+        }
+        command.spans.push_back(Span { coord.row, coord.col, 1 });
+    }
+
+    // a floor edit changes more than the resident tiles
+    if (command.bulk != Bulk::None or not command.spans.empty() or not command.deltas.empty())
+        push(std::move(command));
+}
+
+void EditHistory::beginStroke()
+{
+    endStroke();
+    inStroke = true;
+}
+
+void EditHistory::endStroke()
+{
+    if (not inStroke)
+        return;
+    inStroke = false;
+    strokeTiles.clear();
+
+    // tiles changed and changed back by the stroke
+    auto &deltas = stroke.deltas;
+    deltas.erase(std::remove_if(deltas.begin(), deltas.end(), [](const Delta &delta) {
+        return delta.before == delta.after;
+    }), deltas.end());
+
+    if (not deltas.empty())
+        push(std::move(stroke));
+    stroke = Command();
+}
+
+void EditHistory::beginGroup()
+{
+    groupStroke = not inStroke;
+    if (groupStroke)
+        beginStroke();
+}
+
+void EditHistory::endGroup()
+{
+    if (groupStroke)
+        endStroke();
+    groupStroke = false;
+}
+
+void EditHistory::push(Command &&command)
+{
+    undone.clear();
+    memory += command.bytes();
+    done.push_back(std::move(command));
+    while (memory > MEMORY_LIMIT and done.size() > 1) {
+        memory -= done.front().bytes();
+        done.pop_front();
+    }
+}
+
+bool EditHistory::undo(TileView &tv, const TimeStamp &now)
+{
+    endStroke();
+    if (done.empty())
+        return false;
+    apply(tv, done.back(), true, now);
+    if (done.back().bulk != Bulk::None)
+        tv.undoFloorEdit(now, done.back().bulk, done.back().floor);
+    memory -= done.back().bytes();
+    undone.push_back(std::move(done.back()));
+    done.pop_back();
+    return true;
+}
+
+bool EditHistory::redo(TileView &tv, const TimeStamp &now)
+{
+    endStroke();
+    if (undone.empty())
+        return false;
+    if (undone.back().bulk != Bulk::None) {
+        // made again, the chunks resident and packed may have changed since;
+        // the commands that followed it can still be redone
+        const auto bulk = undone.back().bulk;
+        undone.pop_back();
+        auto later = std::move(undone);
+        editFloor(tv, now, bulk);
+        undone = std::move(later);
+        return true;
+    }
+    apply(tv, undone.back(), false, now);
+    memory += undone.back().bytes();
+    done.push_back(std::move(undone.back()));
+    undone.pop_back();
+    return true;
+}
+
+void EditHistory::clear()
+{
+    done.clear();
+    undone.clear();
+    memory = 0;
+    before.clear();
+    bulk = Bulk::None;
+    floor = FloorUndo();
+    inStroke = false;
+    groupStroke = false;
+    stroke = Command();
+    strokeTiles.clear();
+}
+
+void EditHistory::apply(TileView &tv, const TileCoord &coord, State state, const TimeStamp &now)
+{
+    auto tile = tv.tile(tv.editableTile(coord));
+    tile.setColor((TileColor) colorOf(state));
+    tile.setOrientation((Orientation) orientationOf(state));
+    if (state & ENABLED)
+        tile.start_enabling(now);
+    else
+        tile.start_disabling(now);
+}
+
+void EditHistory::apply(TileView &tv, const Command &command, bool inverse, const TimeStamp &now)
+{
+    for (const auto &span : command.spans) {
+        for (std::uint32_t i = 0; i < span.count; ++i) {
+            const TileCoord coord { span.row, span.col + (int) i };
+            const auto id = tv.editableTile(coord);
+            apply(tv, coord, transform(command.bulk, state(tv.tiles, id), inverse), now);
+        }
+    }
+    for (const auto &delta : command.deltas)
+        apply(tv, delta.coord, inverse ? delta.before : delta.after, now);
+}
@@ -0,0 +1,139 @@
+/*
+ * EditHistory.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_EDITHISTORY_H_
+#define SRC_EDITHISTORY_H_
+
+#include "Clock.h"
+#include "FloorEdit.h"
+#include "TileCoord.h"
+#include "TileStore.h"
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+struct TileView;
+
+// Undo and redo of tile edits.
+// Each command keeps only the tiles it changed, by coordinate, so it can be
+// undone after the tiles were packed away into their chunk.
+// An edit of the whole floor is kept as the operation and the runs of resident tiles
+// it was applied to, a few bytes per row instead of a few bytes per tile;
+// the chunks that are not resident are undone by TileView::undoFloorEdit.
+// The edits of a mouse stroke, from press to release, make a single command.
+class EditHistory
+{
+public:
+    // memory kept for commands, the oldest are forgotten beyond it
+    static constexpr size_t MEMORY_LIMIT = 16 << 20;
+
+    using Bulk = FloorOp;
+
+    // remembers the tiles before they are edited
+    void begin(const TileStore &tiles, const std::vector<TileId> &ids);
+    // records the tiles changed since begin as a command,
+    // or adds them to the command of the stroke in progress
+    void end(const TileStore &tiles);
+
+    // applies bulk to the whole floor with TileView::editFloor and records it as a command
+    void editFloor(TileView &tv, const TimeStamp &now, Bulk bulk);
+    // after the floor was saved with its floor edits folded in;
+    // the floor cannot be undisabled past that
+    void floorSaved();
+
+    void beginStroke();
+    void endStroke();
+    // the edits until endGroup make a single command,
+    // or go to the stroke in progress if there is one
+    void beginGroup();
+    void endGroup();
+
+    bool canUndo() const
+    {
+        return !done.empty();
+    }
+    bool canRedo() const
+    {
+        return !undone.empty();
+    }
+
+    bool undo(TileView &tv, const TimeStamp &now);
+    bool redo(TileView &tv, const TimeStamp &now);
+
+    void clear();
+
+    size_t memoryUsed() const
+    {
+        return memory;
+    }
+
+private:
+    // enabled << 4 | color << 2 | orientation
+    using State = std::uint8_t;
+
+    struct Delta
+    {
+        TileCoord coord;
+        State before;
+        State after;
+    };
+
+    // tiles (row, col) to (row, col + count - 1)
+    struct Span
+    {
+        std::int32_t row;
+        std::int32_t col;
+        std::uint32_t count;
+    };
+
+    struct Command
+    {
+        Bulk bulk = Bulk::None;
+        std::vector<Span> spans;
+        std::vector<Delta> deltas;
+        // of a floor edit, bulk is not None
+        FloorUndo floor;
+
+        size_t bytes() const
+        {
+            return sizeof(Command) + spans.size() * sizeof(Span) + deltas.size() * sizeof(Delta) + floor.bytes();
+        }
+    };
+
+    struct Snapshot
+    {
+        TileId id;
+        State state;
+    };
+
+    static State state(const TileStore &tiles, TileId id);
+    static State transform(Bulk bulk, State state, bool inverse);
+    static void apply(TileView &tv, const TileCoord &coord, State state, const TimeStamp &now);
+    static void apply(TileView &tv, const Command &command, bool inverse, const TimeStamp &now);
+
+    void push(Command &&command);
+
+    std::deque<Command> done;
+    std::vector<Command> undone;
+    size_t memory = 0;
+
+    std::vector<Snapshot> before;
+    Bulk bulk = Bulk::None;
+    // of the floor edit being recorded
+    FloorUndo floor;
+
+    bool inStroke = false;
+    // the stroke was begun by beginGroup
+    bool groupStroke = false;
+    Command stroke;
+    // index of the tiles in stroke.deltas
+    std::unordered_map<TileCoord, size_t> strokeTiles;
+};
+
+#endif /* SRC_EDITHISTORY_H_ */
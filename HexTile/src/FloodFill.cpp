@@ -0,0 +1,102 @@
+/*
+ * FloodFill.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "FloodFill.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+static constexpr size_t SLICE_SIZE = 1024;
+
+FloodFill::FloodFill(WorkerPool &pool) :
+    pool(pool)
+{
+}
+
+void FloodFill::nextGeneration(size_t capacity)
+{
+    if (capacity > markCount) {
+        markCount = std::max(capacity, markCount * 2);
+        marks.reset(new std::atomic<std::uint32_t>[markCount]);
+        for (size_t i = 0; i < markCount; ++i)
+            marks[i].store(0, std::memory_order_relaxed);
+        generation = 0;
+    }
+    generation += 2;
+    if (generation == 0) {
+        for (size_t i = 0; i < markCount; ++i)
+            marks[i].store(0, std::memory_order_relaxed);
+        generation = 2;
+    }
+}
+
+bool FloodFill::isAffectedBy(const TileStore &tiles, TileId id) const
+{
+    if (wasVisited(id))
+        return true;
+    // a new tile may connect to the result
+    for (const auto &coord : tiles.coord(id).neighbours()) {
+        const auto next = tiles.find(coord);
+        if (next != NO_TILE && contains(next))
+            return true;
+    }
+    return false;
+}
+
+template <typename Push>
+void FloodFill::expand(const TileStore &tiles, unsigned state, TileId id, Push push)
+{
+    for (const auto &coord : tiles.coord(id).neighbours()) {
+        const auto next = tiles.find(coord);
+        if (next != NO_TILE && visit(next) && tiles.floodState(next) == state) {
+            accept(next);
+            push(next);
+        }
+    }
+}
+
+void FloodFill::run(const TileStore &tiles, TileId from, std::vector<TileId> &found)
+{
+    found.clear();
+    if (from == NO_TILE)
+        return;
+
+    nextGeneration(tiles.capacity());
+
+    const auto state = tiles.floodState(from);
+
+    visit(from);
+    accept(from);
+    found.push_back(from);
+    frontier.assign(1, from);
+
+    while (not frontier.empty()) {
+        next.clear();
+
+        if (frontier.size() < PARALLEL_FRONTIER || pool.size() == 1) {
+            for (auto id : frontier)
+                expand(tiles, state, id, [this](TileId id) { next.push_back(id); });
+        } else {
+            const size_t count = (frontier.size() + SLICE_SIZE - 1) / SLICE_SIZE;
+            if (slices.size() < count)
+                slices.resize(count);
+
+            pool.parallel_for(frontier.size(), SLICE_SIZE, [&](size_t begin, size_t end) {
+                auto &slice = slices[begin / SLICE_SIZE];
+                slice.clear();
+                for (size_t i = begin; i < end; ++i)
+                    expand(tiles, state, frontier[i], [&slice](TileId id) { slice.push_back(id); });
+            });
+
+            for (size_t i = 0; i < count; ++i)
+                next.insert(next.end(), slices[i].begin(), slices[i].end());
+        }
+
+        found.insert(found.end(), next.begin(), next.end());
+        frontier.swap(next);
+    }
+}
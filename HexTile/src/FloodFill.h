@@ -0,0 +1,91 @@
+/*
+ * FloodFill.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_FLOODFILL_H_
+#define SRC_FLOODFILL_H_
+
+#include "TileStore.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class WorkerPool;
+
+// Breadth first flood fill over the tiles of a TileStore.
+// Visited tiles are stamped with the number of the fill, so nothing has
+// to be cleared between fills and nothing is allocated once the buffers
+// have grown. The fill expands one level (ring) at a time; levels larger
+// than PARALLEL_FRONTIER are expanded by the worker pool.
+// The stamps tell apart the tiles of the result and the tiles bordering it
+// until the next run.
+class FloodFill
+{
+public:
+    static constexpr size_t PARALLEL_FRONTIER = 4096;
+
+    explicit FloodFill(WorkerPool &pool);
+
+    // collects the tiles connected to from with the same floodState()
+    void run(const TileStore &tiles, TileId from, std::vector<TileId> &found);
+
+    // true if the tile was found by the last run
+    bool contains(TileId id) const
+    {
+        return generation != 0 && mark(id) == generation;
+    }
+
+    // true if the tile was looked at by the last run:
+    // it is either part of the result or borders it
+    bool wasVisited(TileId id) const
+    {
+        const auto m = mark(id);
+        return generation != 0 && (m == generation || m == generation + 1);
+    }
+
+    // true if changing the tile may change the result of the last run
+    bool isAffectedBy(const TileStore &tiles, TileId id) const;
+
+private:
+    std::uint32_t mark(TileId id) const
+    {
+        return id < markCount ? marks[id].load(std::memory_order_relaxed) : 0;
+    }
+
+    // claims the tile for this thread, marking it as bordering the result
+    bool visit(TileId id)
+    {
+        auto m = marks[id].load(std::memory_order_relaxed);
+        if (m == generation || m == generation + 1)
+            return false;
+        return marks[id].compare_exchange_strong(m, generation + 1, std::memory_order_relaxed);
+    }
+
+    void accept(TileId id)
+    {
+        marks[id].store(generation, std::memory_order_relaxed);
+    }
+
+    template <typename Push>
+    void expand(const TileStore &tiles, unsigned state, TileId id, Push push);
+
+    void nextGeneration(size_t capacity);
+
+    WorkerPool &pool;
+
+    std::unique_ptr<std::atomic<std::uint32_t>[]> marks;
+    size_t markCount = 0;
+    // the result is stamped with generation, the border with generation + 1
+    std::uint32_t generation = 0;
+
+    std::vector<TileId> frontier;
+    std::vector<TileId> next;
+    std::vector<std::vector<TileId>> slices;
+};
+
+#endif /* SRC_FLOODFILL_H_ */
@@ -0,0 +1,93 @@
+/*
+ * FloorEdit.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "FloorEdit.h"
+
+#include <ciso646>
+
+#include <algorithm>
+
+FloorEdit FloorEdit::then(FloorOp op) const
+{
+    FloorEdit edit = *this;
+    if (disable)
+        return edit;
+    switch (op) {
+    case FloorOp::None:
+        break;
+    case FloorOp::ColorUp:
+        edit.shade = std::uint8_t((shade + 1) % 3);
+        break;
+    case FloorOp::ColorDown:
+        edit.shade = std::uint8_t((shade + 2) % 3);
+        break;
+    case FloorOp::FlipOrientation:
+        edit.flip = not flip;
+        break;
+    case FloorOp::Disable:
+        edit = FloorEdit();
+        edit.disable = true;
+        break;
+    }
+    return edit;
+}
+
+FloorOp FloorEdit::inverse(FloorOp op)
+{
+    switch (op) {
+    case FloorOp::ColorUp:
+        return FloorOp::ColorDown;
+    case FloorOp::ColorDown:
+        return FloorOp::ColorUp;
+    default:
+        return op;
+    }
+}
+
+void FloorEdit::apply(ChunkData &data) const
+{
+    if (disable) {
+        data.fill(0);
+        return;
+    }
+    if (isNone())
+        return;
+
+    auto *colors = data.data();
+    auto *orientations = colors + ChunkBits::COLOR_BYTES;
+    ChunkBits::forEachEnabled(data.data(), [&](unsigned slot) {
+        const unsigned shift = slot % 4 * 2;
+        const unsigned color = (colors[slot / 4] >> shift & 3) + shade;
+        colors[slot / 4] = std::uint8_t((colors[slot / 4] & ~(3 << shift)) | color % 3 << shift);
+        const unsigned orientation = orientations[slot / 4] >> shift & 3;
+        if (flip and orientation != 0)
+            orientations[slot / 4] ^= std::uint8_t(3 << shift);
+    });
+}
+
+FloorPattern FloorEdit::apply(const FloorPattern &pattern) const
+{
+    if (disable)
+        return FloorPattern();
+    return FloorPattern(pattern.getKind(), pattern.getShade() + shade, pattern.isFlipped() != flip);
+}
+
+bool FloorUndo::wasResident(const ChunkCoord &chunk) const
+{
+    return std::binary_search(resident.begin(), resident.end(), chunk);
+}
+
+const ChunkData *FloorUndo::packedChunk(const ChunkCoord &chunk) const
+{
+    const auto found = std::lower_bound(packed.begin(), packed.end(), chunk,
+                                        [](const std::pair<ChunkCoord, ChunkData> &entry, const ChunkCoord &coord) {
+        return entry.first < coord;
+    });
+    if (found != packed.end() and found->first == chunk)
+        return &found->second;
+    return nullptr;
+}
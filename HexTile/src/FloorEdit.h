@@ -0,0 +1,75 @@
+/*
+ * FloorEdit.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_FLOOREDIT_H_
+#define SRC_FLOOREDIT_H_
+
+#include "FloorPattern.h"
+#include "TileChunk.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// The edits of the whole floor: recolouring, turning the cubes over and disabling.
+// They only touch enabled tiles, the same way whatever the tile or the chunk,
+// so a chunk that is not read in can be edited when it is.
+enum class FloorOp : std::uint8_t
+{
+    None,
+    ColorUp,
+    ColorDown,
+    FlipOrientation,
+    Disable,
+};
+
+// Floor edits folded into one, to apply to chunks packed before they were made.
+// Recolouring and flipping commute, so any sequence of them is a shade and a flip.
+struct FloorEdit
+{
+    // added to the colour of the enabled tiles, modulo three
+    std::uint8_t shade = 0;
+    // odd and even orientations swapped
+    bool flip = false;
+    // no tile is left enabled, shade and flip do not matter
+    bool disable = false;
+
+    bool isNone() const
+    {
+        return shade == 0 && !flip && !disable;
+    }
+
+    // this edit followed by op
+    FloorEdit then(FloorOp op) const;
+
+    static FloorOp inverse(FloorOp op);
+
+    void apply(ChunkData &data) const;
+    FloorPattern apply(const FloorPattern &pattern) const;
+};
+
+// What it takes to undo a floor edit besides the resident tiles it changed
+struct FloorUndo
+{
+    // the edit applied to the saved and pattern chunks before
+    FloorEdit base;
+    // the chunks that had their tiles in the store, sorted
+    std::vector<ChunkCoord> resident;
+    // the chunks before they were disabled, resident and packed, sorted
+    std::vector<std::pair<ChunkCoord, ChunkData>> packed;
+
+    bool wasResident(const ChunkCoord &chunk) const;
+    // the chunk before it was disabled, nullptr if it was not kept
+    const ChunkData *packedChunk(const ChunkCoord &chunk) const;
+
+    size_t bytes() const
+    {
+        return resident.size() * sizeof(ChunkCoord) + packed.size() * sizeof(packed[0]);
+    }
+};
+
+#endif /* SRC_FLOOREDIT_H_ */
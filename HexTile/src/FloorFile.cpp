@@ -0,0 +1,207 @@
+/*
+ * FloorFile.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "FloorFile.h"
+
+#include <ciso646>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char MAGIC[8] = { 'H', 'E', 'X', 'F', 'L', 'O', 'O', 'R' };
+static constexpr size_t HEADER_SIZE = 32;
+static constexpr size_t PATTERN_HEADER_SIZE = 40;
+static constexpr size_t INDEX_ENTRY_SIZE = 16;
+
+static std::uint64_t load(const std::uint8_t *bytes, unsigned count)
+{
+    std::uint64_t value = 0;
+    for (unsigned i = count; i-- > 0;)
+        value = value << 8 | bytes[i];
+    return value;
+}
+
+static void store(std::vector<std::uint8_t> &out, std::uint64_t value, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i, value >>= 8)
+        out.push_back(std::uint8_t(value));
+}
+
+FloorFile::~FloorFile()
+{
+    close();
+}
+
+bool FloorFile::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) and fileSize.QuadPart >= (LONGLONG) HEADER_SIZE) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            data = (const std::uint8_t *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            size = (size_t) fileSize.QuadPart;
+        }
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 and st.st_size >= (off_t) HEADER_SIZE) {
+        void *mapped = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = (const std::uint8_t *) mapped;
+            size = (size_t) st.st_size;
+        }
+    }
+    ::close(fd);
+#endif
+
+    if (data == nullptr
+        or std::memcmp(data, MAGIC, sizeof MAGIC) != 0
+        or load(data + 8, 4) < 1 or load(data + 8, 4) > VERSION
+        or load(data + 12, 4) != CHUNK_ROWS
+        or load(data + 16, 4) != CHUNK_COLS) {
+        close();
+        return false;
+    }
+
+    if (load(data + 8, 4) >= 2) {
+        if (size < PATTERN_HEADER_SIZE or load(data + 32, 4) >= FloorPattern::KINDS
+            or load(data + 36, 4) >> 3 != 0 or (load(data + 36, 4) & 3) == 3) {
+            close();
+            return false;
+        }
+        const auto edit = load(data + 36, 4);
+        pattern = FloorPattern((FloorPattern::Kind) load(data + 32, 4), edit & 3, (edit >> 2) != 0);
+    }
+
+    count = (size_t) load(data + 20, 4);
+    const auto indexOffset = load(data + 24, 8);
+    if (indexOffset > size or (size - indexOffset) / INDEX_ENTRY_SIZE < count) {
+        close();
+        return false;
+    }
+    index = data + indexOffset;
+
+    this->path = path;
+    return true;
+}
+
+void FloorFile::close()
+{
+#ifdef _WIN32
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    if (file != nullptr)
+        CloseHandle(file);
+    mapping = file = nullptr;
+#else
+    if (data != nullptr)
+        munmap((void *) data, size);
+#endif
+    data = index = nullptr;
+    size = count = 0;
+    pattern = FloorPattern();
+    path.clear();
+}
+
+ChunkCoord FloorFile::chunkCoord(size_t i) const
+{
+    const auto *entry = index + i * INDEX_ENTRY_SIZE;
+    return ChunkCoord { (std::int32_t) load(entry, 4), (std::int32_t) load(entry + 4, 4) };
+}
+
+const std::uint8_t *FloorFile::chunk(size_t i) const
+{
+    const auto offset = load(index + i * INDEX_ENTRY_SIZE + 8, 8);
+    if (offset > size or size - offset < ChunkBits::SIZE)
+        return nullptr;
+    return data + offset;
+}
+
+const std::uint8_t *FloorFile::find(const ChunkCoord &coord) const
+{
+    size_t begin = 0, end = count;
+    while (begin < end) {
+        const size_t middle = begin + (end - begin) / 2;
+        if (chunkCoord(middle) < coord)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+    if (begin < count and chunkCoord(begin) == coord)
+        return chunk(begin);
+    return nullptr;
+}
+
+bool FloorFile::write(const std::string &path, const std::vector<Chunk> &chunks, FloorPattern pattern)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (not out)
+        return false;
+
+    // designs without a pattern stay readable by version 1
+    const size_t headerSize = pattern.isNone() ? HEADER_SIZE : PATTERN_HEADER_SIZE;
+    const std::uint64_t indexOffset = headerSize + chunks.size() * ChunkBits::SIZE;
+
+    std::vector<std::uint8_t> bytes(MAGIC, MAGIC + sizeof MAGIC);
+    store(bytes, pattern.isNone() ? 1 : VERSION, 4);
+    store(bytes, CHUNK_ROWS, 4);
+    store(bytes, CHUNK_COLS, 4);
+    store(bytes, chunks.size(), 4);
+    store(bytes, indexOffset, 8);
+    if (not pattern.isNone()) {
+        store(bytes, pattern.getKind(), 4);
+        store(bytes, pattern.getShade() | (pattern.isFlipped() ? 4 : 0), 4);
+    }
+    out.write((const char *) bytes.data(), bytes.size());
+
+    for (const auto &chunk : chunks)
+        out.write((const char *) chunk.second, ChunkBits::SIZE);
+
+    bytes.clear();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        store(bytes, (std::uint32_t) chunks[i].first.row, 4);
+        store(bytes, (std::uint32_t) chunks[i].first.col, 4);
+        store(bytes, headerSize + i * ChunkBits::SIZE, 8);
+    }
+    out.write((const char *) bytes.data(), bytes.size());
+
+    out.close();
+    return not out.fail();
+}
+
+bool FloorFile::replace(const std::string &from, const std::string &path)
+{
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), path.c_str()) == 0;
+#endif
+}
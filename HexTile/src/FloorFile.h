@@ -0,0 +1,105 @@
+/*
+ * FloorFile.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_FLOORFILE_H_
+#define SRC_FLOORFILE_H_
+
+#include "FloorPattern.h"
+#include "TileChunk.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A saved floor design, mapped into memory while it is open.
+// Chunks are only read when they are asked for, so opening a file takes
+// the same time whatever the size of the design.
+//
+// Version 1 layout, integers are little endian:
+//    0  char[8]  "HEXFLOOR"
+//    8  u32      version
+//   12  u32      CHUNK_ROWS
+//   16  u32      CHUNK_COLS
+//   20  u32      number of chunks
+//   24  u64      offset of the index
+//   32           chunks, ChunkBits::SIZE bytes each
+//   index        per chunk: i32 row, i32 col, u64 offset; sorted by row, then col
+//
+// Only chunks with enabled tiles are saved.
+// Version 2 is written for designs on a pattern; the header goes on with
+//   32  u32      FloorPattern::Kind
+//   36  u32      shade | flipped << 2, see FloorPattern; 0 in older files
+//   40           chunks
+// and only the chunks that differ from the pattern are saved.
+class FloorFile
+{
+public:
+    static constexpr std::uint32_t VERSION = 2;
+
+    using Chunk = std::pair<ChunkCoord, const std::uint8_t *>;
+
+    FloorFile() = default;
+    ~FloorFile();
+
+    FloorFile(const FloorFile &) = delete;
+    FloorFile &operator =(const FloorFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const
+    {
+        return data != nullptr;
+    }
+
+    const std::string &getPath() const
+    {
+        return path;
+    }
+
+    // the tiles of the chunks that are not saved
+    const FloorPattern &getPattern() const
+    {
+        return pattern;
+    }
+
+    size_t chunkCount() const
+    {
+        return count;
+    }
+
+    // chunks are sorted by their coordinates
+    ChunkCoord chunkCoord(size_t i) const;
+    const std::uint8_t *chunk(size_t i) const;
+
+    // the saved bits of the chunk, nullptr if it is not saved
+    const std::uint8_t *find(const ChunkCoord &coord) const;
+
+    // the chunks have to be sorted by their coordinates
+    static bool write(const std::string &path, const std::vector<Chunk> &chunks, FloorPattern pattern = FloorPattern());
+    // renames from to path, replacing the file at path in one step;
+    // if it fails, the file at path is left as it was
+    static bool replace(const std::string &from, const std::string &path);
+
+private:
+    std::string path;
+
+    const std::uint8_t *data = nullptr;
+    size_t size = 0;
+    const std::uint8_t *index = nullptr;
+    size_t count = 0;
+    FloorPattern pattern;
+
+#ifdef _WIN32
+    void *file = nullptr;
+    void *mapping = nullptr;
+#endif
+};
+
+#endif /* SRC_FLOORFILE_H_ */
@@ -0,0 +1,38 @@
+/*
+ * FloorPattern.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "FloorPattern.h"
+
+#include <ciso646>
+
+bool FloorPattern::tile(const TileCoord &coord, unsigned &color, unsigned &orientation) const
+{
+    switch (kind) {
+    case TumblingBlocks:
+        // the six neighbours of a tile are one or two rows away,
+        // so colouring by row modulo three never puts two shades together
+        color = unsigned((coord.row % 3 + 3 + shade) % 3);
+        orientation = flipped ? 2 : 1;
+        return true;
+    case None:
+    case KINDS:
+        break;
+    }
+    return false;
+}
+
+void FloorPattern::fill(const ChunkCoord &chunk, ChunkData &data) const
+{
+    data.fill(0);
+    if (kind == None)
+        return;
+    for (unsigned slot = 0; slot < CHUNK_TILES; ++slot) {
+        unsigned color, orientation;
+        if (tile(chunk.tile(slot), color, orientation))
+            ChunkBits::set(data.data(), slot, color, orientation, true);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * FloorPattern.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_FLOORPATTERN_H_
+#define SRC_FLOORPATTERN_H_
+
+#include "TileChunk.h"
+#include "TileCoord.h"
+
+#include <cstdint>
+
+// The tiles of a floor that nobody placed, a function of the coordinates only.
+// A design keeps just the chunks that differ from its pattern,
+// so an endless patterned floor takes memory only for what was edited.
+class FloorPattern
+{
+public:
+    // saved in floor files, new kinds go to the end
+    enum Kind : std::uint32_t
+    {
+        None,
+        // cubes in three shades, no two neighbours alike
+        TumblingBlocks,
+        KINDS
+    };
+
+    // shade is added to the colours modulo three, flipped swaps the orientations
+    FloorPattern(Kind kind = None, unsigned shade = 0, bool flipped = false) :
+        kind(kind), shade(shade % 3), flipped(flipped)
+    {
+    }
+
+    Kind getKind() const
+    {
+        return kind;
+    }
+
+    unsigned getShade() const
+    {
+        return shade;
+    }
+
+    bool isFlipped() const
+    {
+        return flipped;
+    }
+
+    bool isNone() const
+    {
+        return kind == None;
+    }
+
+    // the tile of the pattern at coord, false where it has none
+    bool tile(const TileCoord &coord, unsigned &color, unsigned &orientation) const;
+
+    // the bits of the tiles of the pattern in the chunk
+    void fill(const ChunkCoord &chunk, ChunkData &data) const;
+
+private:
+    Kind kind;
+    unsigned shade;
+    bool flipped;
+};
+
+#endif /* SRC_FLOORPATTERN_H_ */
@@ -0,0 +1,35 @@
+/*
+ * FrameScheduler.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "FrameScheduler.h"
+
+#include <ofAppRunner.h>
+
+#include <ciso646>
+
+constexpr std::chrono::seconds FrameScheduler::IDLE_DELAY;
+
+void FrameScheduler::wake(const TimeStamp &now)
+{
+    lastActive = now;
+    if (not idle)
+        return;
+    idle = false;
+    ofSetFrameRate(ACTIVE_FRAME_RATE);
+}
+
+void FrameScheduler::update(const TimeStamp &now, bool animating)
+{
+    if (animating) {
+        wake(now);
+        return;
+    }
+    if (idle or now - lastActive < IDLE_DELAY)
+        return;
+    idle = true;
+    ofSetFrameRate(IDLE_FRAME_RATE);
+}
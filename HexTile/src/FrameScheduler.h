@@ -0,0 +1,45 @@
+/*
+ * FrameScheduler.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_FRAMESCHEDULER_H_
+#define SRC_FRAMESCHEDULER_H_
+
+#include "Clock.h"
+
+// Lowers the frame rate while nothing on the screen moves.
+// The app is active while anything animates and for IDLE_DELAY after the last
+// input, which is as long as the focus keeps pulsing; then the frame rate drops
+// to IDLE_FRAME_RATE until the next input or animation.
+class FrameScheduler
+{
+public:
+    static constexpr int ACTIVE_FRAME_RATE = 120;
+    // also the longest delay before the first input after idling is handled
+    static constexpr int IDLE_FRAME_RATE = 10;
+    static constexpr std::chrono::seconds IDLE_DELAY { 5 };
+
+    bool isIdle() const
+    {
+        return idle;
+    }
+    // when the app went idle, or would go idle if nothing happens
+    TimeStamp idleSince() const
+    {
+        return lastActive + IDLE_DELAY;
+    }
+
+    // input arrived, back to the full frame rate
+    void wake(const TimeStamp &now);
+    // once a frame; animating when anything moved since the last frame
+    void update(const TimeStamp &now, bool animating);
+
+private:
+    bool idle = false;
+    TimeStamp lastActive = Clock::now();
+};
+
+#endif /* SRC_FRAMESCHEDULER_H_ */
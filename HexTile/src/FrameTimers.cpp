@@ -0,0 +1,108 @@
+/*
+ * FrameTimers.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "FrameTimers.h"
+
+#include <ciso646>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+const char *FrameTimers::name(FramePhase phase)
+{
+    switch (phase) {
+    case FramePhase::Update:
+        return "update";
+    case FramePhase::UpdateSelected:
+        return "updateSelected";
+    case FramePhase::UpdateCrowd:
+        return "updateCrowd";
+    case FramePhase::UpdateAlpha:
+        return "update_alpha";
+    case FramePhase::DrawToFramebuffer:
+        return "drawToFramebuffer";
+    case FramePhase::DrawFocus:
+        return "drawFocus";
+    case FramePhase::DrawSticky:
+        return "drawSticky";
+    }
+    return "";
+}
+
+void FrameTimers::add(FramePhase phase, Duration duration)
+{
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    auto &total = current[(size_t) phase];
+    total = (std::uint32_t) std::min<std::uint64_t>(
+        std::uint64_t(total) + std::uint64_t(std::max<decltype(micros)>(micros, 0)),
+        std::numeric_limits<std::uint32_t>::max());
+}
+
+void FrameTimers::endFrame()
+{
+    const auto frame = published.load(std::memory_order_relaxed);
+    auto &slot = ring[frame % FRAMES];
+    for (size_t i = 0; i < PHASES; ++i)
+        slot[i].store(current[i], std::memory_order_relaxed);
+    published.store(frame + 1, std::memory_order_release);
+    current.fill(0);
+}
+
+std::vector<FrameTimers::Micros> FrameTimers::copy(std::uint64_t &first) const
+{
+    const auto end = published.load(std::memory_order_acquire);
+    first = end > FRAMES ? end - FRAMES : 0;
+
+    std::vector<Micros> frames;
+    frames.reserve(size_t(end - first));
+    for (auto frame = first; frame < end; ++frame) {
+        Micros micros;
+        const auto &slot = ring[frame % FRAMES];
+        for (size_t i = 0; i < PHASES; ++i)
+            micros[i] = slot[i].load(std::memory_order_relaxed);
+        frames.push_back(micros);
+    }
+    return frames;
+}
+
+float FrameTimers::quantile(FramePhase phase, float q) const
+{
+    std::uint64_t first;
+    const auto frames = copy(first);
+    if (frames.empty())
+        return 0;
+
+    std::vector<std::uint32_t> times;
+    times.reserve(frames.size());
+    for (const auto &frame : frames)
+        times.push_back(frame[(size_t) phase]);
+    const auto nth = times.begin() + std::min(size_t(q * times.size()), times.size() - 1);
+    std::nth_element(times.begin(), nth, times.end());
+    return *nth / 1000.f;
+}
+
+bool FrameTimers::writeCsv(const std::string &path) const
+{
+    std::ofstream csv(path);
+    if (not csv)
+        return false;
+
+    csv << "frame";
+    for (size_t i = 0; i < PHASES; ++i)
+        csv << ',' << name((FramePhase) i) << "_us";
+    csv << '\n';
+
+    std::uint64_t frame;
+    for (const auto &micros : copy(frame)) {
+        csv << frame++;
+        for (auto value : micros)
+            csv << ',' << value;
+        csv << '\n';
+    }
+    return bool(csv);
+}
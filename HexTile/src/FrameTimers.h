@@ -0,0 +1,88 @@
+/*
+ * FrameTimers.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_FRAMETIMERS_H_
+#define SRC_FRAMETIMERS_H_
+
+#include "Clock.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class FramePhase
+{
+    Update,
+    UpdateSelected,
+    UpdateCrowd,
+    UpdateAlpha,
+    DrawToFramebuffer,
+    DrawFocus,
+    DrawSticky,
+};
+
+// Time spent in each phase of the last FRAMES frames.
+// The phases of a frame are summed up while it runs and published by endFrame
+// into a ring of atomics, so the numbers can be read from another thread
+// without stopping the frame loop; a reader racing the writer may see a frame
+// mixed from two laps of the ring, which is fine for statistics.
+class FrameTimers
+{
+public:
+    static constexpr size_t PHASES = 7;
+    static constexpr size_t FRAMES = 1024;
+
+    static const char *name(FramePhase phase);
+
+    // adds the time until it is destroyed to the phase
+    class Scope
+    {
+    public:
+        Scope(FrameTimers &timers, FramePhase phase) :
+            timers(timers),
+            phase(phase),
+            start(Clock::now())
+        {
+        }
+        ~Scope()
+        {
+            timers.add(phase, Clock::now() - start);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator =(const Scope &) = delete;
+
+    private:
+        FrameTimers &timers;
+        FramePhase phase;
+        TimeStamp start;
+    };
+
+    void add(FramePhase phase, Duration duration);
+    void endFrame();
+
+    // milliseconds spent in the phase per frame, at the quantile q of the recorded frames
+    float quantile(FramePhase phase, float q) const;
+
+    // one line per recorded frame, oldest first, times in microseconds
+    bool writeCsv(const std::string &path) const;
+
+private:
+    using Micros = std::array<std::uint32_t, PHASES>;
+
+    // the recorded frames, oldest first; first is the number of the oldest
+    std::vector<Micros> copy(std::uint64_t &first) const;
+
+    Micros current {};
+
+    std::array<std::array<std::atomic<std::uint32_t>, PHASES>, FRAMES> ring {};
+    std::atomic<std::uint64_t> published { 0 };
+};
+
+#endif /* SRC_FRAMETIMERS_H_ */
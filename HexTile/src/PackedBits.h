@@ -0,0 +1,92 @@
+/*
+ * PackedBits.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_PACKEDBITS_H_
+#define SRC_PACKEDBITS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+inline unsigned lowestBitIndex(std::uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    unsigned index = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+inline unsigned countBits(std::uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    unsigned count = 0;
+    for (; word != 0; word &= word - 1)
+        ++count;
+    return count;
+#endif
+}
+
+// Array of small unsigned values, BITS bits each, packed into 64 bit words.
+// PackedBits<1> words can be scanned directly to skip 64 clear entries at a time.
+template <unsigned BITS>
+class PackedBits
+{
+    static_assert(BITS > 0 && 64 % BITS == 0, "values must not straddle words");
+
+public:
+    static constexpr unsigned PER_WORD = 64 / BITS;
+    static constexpr std::uint64_t MASK = (std::uint64_t(1) << BITS) - 1;
+
+    void resize(size_t size)
+    {
+        words.resize((size + PER_WORD - 1) / PER_WORD, 0);
+    }
+
+    unsigned get(size_t i) const
+    {
+        return (words[i / PER_WORD] >> shift(i)) & MASK;
+    }
+
+    void set(size_t i, unsigned value)
+    {
+        auto &word = words[i / PER_WORD];
+        word = (word & ~(MASK << shift(i))) | (std::uint64_t(value & MASK) << shift(i));
+    }
+
+    size_t wordCount() const
+    {
+        return words.size();
+    }
+
+    std::uint64_t word(size_t w) const
+    {
+        return words[w];
+    }
+
+    std::uint64_t &word(size_t w)
+    {
+        return words[w];
+    }
+
+private:
+    static unsigned shift(size_t i)
+    {
+        return (unsigned) (i % PER_WORD) * BITS;
+    }
+
+    std::vector<std::uint64_t> words;
+};
+
+#endif /* SRC_PACKEDBITS_H_ */
@@ -0,0 +1,183 @@
+/*
+ * PngWriter.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "PngWriter.h"
+
+#include <ciso646>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+static constexpr unsigned MAX_STORED_BLOCK = 65535;
+// adler32 sums may be left unreduced for this many bytes
+static constexpr unsigned ADLER_RUN = 5552;
+static constexpr std::uint32_t ADLER_MOD = 65521;
+
+static std::uint32_t crc32(std::uint32_t crc, const std::uint8_t *bytes, size_t count)
+{
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> table;
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < count; ++i)
+        crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static std::uint32_t adler32(std::uint32_t adler, const std::uint8_t *bytes, size_t count)
+{
+    std::uint32_t a = adler & 0xffff;
+    std::uint32_t b = adler >> 16;
+    while (count > 0) {
+        const size_t run = std::min<size_t>(count, ADLER_RUN);
+        for (size_t i = 0; i < run; ++i) {
+            a += bytes[i];
+            b += a;
+        }
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+        bytes += run;
+        count -= run;
+    }
+    return b << 16 | a;
+}
+
+static void put32(std::vector<std::uint8_t> &out, std::uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(std::uint8_t(value >> shift));
+}
+
+PngWriter::~PngWriter()
+{
+    if (file != nullptr)
+        std::fclose(file);
+}
+
+bool PngWriter::open(const std::string &path, std::uint32_t width, std::uint32_t height, float dpi)
+{
+    if (file != nullptr)
+        close();
+    if (width == 0 or height == 0 or width > (1u << 31) / 3)
+        return false;
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+    ok = true;
+
+    this->width = width;
+    this->height = height;
+    rowsWritten = 0;
+    remaining = std::uint64_t(height) * (1 + std::uint64_t(width) * 3);
+    blockLeft = 0;
+    adler = 1;
+
+    static const std::uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    ok = std::fwrite(SIGNATURE, 1, sizeof SIGNATURE, file) == sizeof SIGNATURE;
+
+    std::vector<std::uint8_t> header;
+    put32(header, width);
+    put32(header, height);
+    // 8 bits per sample, RGB, deflate, adaptive filtering, not interlaced
+    for (std::uint8_t byte : { 8, 2, 0, 0, 0 })
+        header.push_back(byte);
+    writeChunk("IHDR", header);
+
+    if (dpi > 0) {
+        const auto perMetre = (std::uint32_t) std::lround(dpi / 0.0254f);
+        std::vector<std::uint8_t> physical;
+        put32(physical, perMetre);
+        put32(physical, perMetre);
+        physical.push_back(1);
+        writeChunk("pHYs", physical);
+    }
+
+    // zlib header of a stream without compression, the window size does not matter
+    idat = { 0x78, 0x01 };
+    return ok;
+}
+
+bool PngWriter::writeRows(const std::uint8_t *rgb, unsigned rows)
+{
+    if (file == nullptr or rows > height - rowsWritten)
+        return false;
+
+    const size_t rowBytes = size_t(width) * 3;
+    static const std::uint8_t NO_FILTER = 0;
+    for (unsigned row = 0; row < rows; ++row) {
+        deflate(&NO_FILTER, 1);
+        deflate(rgb + row * rowBytes, rowBytes);
+    }
+    rowsWritten += rows;
+
+    if (rowsWritten == height)
+        put32(idat, adler);
+    writeChunk("IDAT", idat);
+    idat.clear();
+    return ok;
+}
+
+bool PngWriter::close()
+{
+    if (file == nullptr)
+        return false;
+    const bool complete = rowsWritten == height;
+    if (complete)
+        writeChunk("IEND", {});
+    ok = std::fclose(file) == 0 and ok;
+    file = nullptr;
+    return ok and complete;
+}
+
+void PngWriter::writeChunk(const char *type, const std::vector<std::uint8_t> &data)
+{
+    std::vector<std::uint8_t> header;
+    put32(header, (std::uint32_t) data.size());
+    header.insert(header.end(), type, type + 4);
+
+    std::uint32_t crc = crc32(0, header.data() + 4, 4);
+    crc = crc32(crc, data.data(), data.size());
+    std::vector<std::uint8_t> trailer;
+    put32(trailer, crc);
+
+    ok = ok
+        and std::fwrite(header.data(), 1, header.size(), file) == header.size()
+        and (data.empty() or std::fwrite(data.data(), 1, data.size(), file) == data.size())
+        and std::fwrite(trailer.data(), 1, trailer.size(), file) == trailer.size();
+}
+
+void PngWriter::deflate(const std::uint8_t *bytes, size_t count)
+{
+    adler = adler32(adler, bytes, count);
+    while (count > 0) {
+        if (blockLeft == 0) {
+            blockLeft = (unsigned) std::min<std::uint64_t>(remaining, MAX_STORED_BLOCK);
+            const bool last = blockLeft == remaining;
+            idat.push_back(last ? 1 : 0);
+            idat.push_back(std::uint8_t(blockLeft));
+            idat.push_back(std::uint8_t(blockLeft >> 8));
+            idat.push_back(std::uint8_t(~blockLeft));
+            idat.push_back(std::uint8_t(~blockLeft >> 8));
+        }
+        const auto run = std::min<size_t>(count, blockLeft);
+        idat.insert(idat.end(), bytes, bytes + run);
+        bytes += run;
+        count -= run;
+        blockLeft -= (unsigned) run;
+        remaining -= run;
+    }
+}
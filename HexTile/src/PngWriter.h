@@ -0,0 +1,56 @@
+/*
+ * PngWriter.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_PNGWRITER_H_
+#define SRC_PNGWRITER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Writes an 8 bit RGB PNG a few rows at a time, so that images much larger
+// than the memory can be written. The pixels are stored without compression,
+// in stored deflate blocks, which needs no zlib and keeps writing as fast as the disk.
+class PngWriter
+{
+public:
+    PngWriter() = default;
+    ~PngWriter();
+
+    PngWriter(const PngWriter &) = delete;
+    PngWriter &operator =(const PngWriter &) = delete;
+
+    // dpi is saved as the physical pixel size if it is not 0
+    bool open(const std::string &path, std::uint32_t width, std::uint32_t height, float dpi = 0);
+
+    // rows of width * 3 bytes each, top to bottom
+    bool writeRows(const std::uint8_t *rgb, unsigned rows);
+
+    // fails if not all the rows were written
+    bool close();
+
+private:
+    void writeChunk(const char *type, const std::vector<std::uint8_t> &data);
+    void deflate(const std::uint8_t *bytes, size_t count);
+
+    std::FILE *file = nullptr;
+    bool ok = false;
+
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t rowsWritten = 0;
+
+    // the uncompressed bytes still to go and what is left of the current stored block
+    std::uint64_t remaining = 0;
+    unsigned blockLeft = 0;
+    std::uint32_t adler = 1;
+
+    std::vector<std::uint8_t> idat;
+};
+
+#endif /* SRC_PNGWRITER_H_ */
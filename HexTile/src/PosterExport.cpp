@@ -0,0 +1,299 @@
+/*
+ * PosterExport.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "PosterExport.h"
+#include "AppConsts.h"
+#include "PngWriter.h"
+#include "TileChunk.h"
+
+#include <ofFileUtils.h>
+#include <ofImage.h>
+
+#include <ciso646>
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr float MM_PER_INCH = 25.4f;
+
+// the colours of TileBatch, without fading
+static constexpr float LINE_ALPHA = 160 / 255.f;
+static constexpr float LINE_GRAY = 20 / 255.f;
+static constexpr float SHADOW_ALPHA = 128 / 255.f;
+static constexpr float FLAT_FILLS[3] = { 2 / 255.f, 96 / 255.f, 1 };
+
+static constexpr float HALF_LINE = LINE_WIDTH_PIX / 2;
+
+// normals of the edges of the hexagon, edge k goes from vertex k to vertex k + 1
+static constexpr float EDGE_NX[6] = { TileParams::sin_60_deg, 0, -TileParams::sin_60_deg,
+                                      -TileParams::sin_60_deg, 0, TileParams::sin_60_deg };
+static constexpr float EDGE_NY[6] = { TileParams::cos_60_deg, 1, TileParams::cos_60_deg,
+                                      -TileParams::cos_60_deg, -1, -TileParams::cos_60_deg };
+
+struct Rgb
+{
+    float r, g, b;
+
+    void blend(float gray, float alpha)
+    {
+        blend(Rgb { gray, gray, gray }, alpha);
+    }
+
+    void blend(const Rgb &color, float alpha)
+    {
+        r += (color.r - r) * alpha;
+        g += (color.g - g) * alpha;
+        b += (color.b - b) * alpha;
+    }
+};
+
+// see TileBatch, lines drawn over each other
+static float doubleAlpha(float alpha)
+{
+    return 2 * alpha - alpha * alpha;
+}
+
+// how much of the pixel a line of LINE_WIDTH_PIX covers at distance from its middle
+static float coverage(float distance, float pixel)
+{
+    return std::min(std::max((HALF_LINE - distance) / pixel + 0.5f, 0.f), 1.f);
+}
+
+static std::uint8_t byte(float value)
+{
+    return std::uint8_t(std::min(std::max(value, 0.f), 1.f) * 255 + 0.5f);
+}
+
+PosterExport::PosterExport(const FloorFile &floor) :
+    floor(floor)
+{
+    findBounds();
+}
+
+bool PosterExport::loadImages(const std::string &dir)
+{
+    bool loaded = true;
+    const char *names[3] = { "black.png", "grey.png", "white.png" };
+    for (unsigned c = 0; c < images.size(); ++c)
+        loaded = ofLoadImage(images[c], ofFilePath::join(dir, names[c])) and loaded;
+    return loaded;
+}
+
+float PosterExport::scale(float dpi)
+{
+    return dpi / MM_PER_INCH / PIX_PER_MM;
+}
+
+std::uint32_t PosterExport::width(float dpi) const
+{
+    return (std::uint32_t) std::ceil(bounds.width * scale(dpi));
+}
+
+std::uint32_t PosterExport::height(float dpi) const
+{
+    return (std::uint32_t) std::ceil(bounds.height * scale(dpi));
+}
+
+void PosterExport::findBounds()
+{
+    // the saved chunks are only the edits of the pattern, not the edge of the design
+    if (isPatterned())
+        return;
+
+    float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+    for (size_t i = 0; i < floor.chunkCount(); ++i) {
+        const auto chunk = floor.chunkCoord(i);
+        ChunkBits::forEachEnabled(floor.chunk(i), [&](unsigned slot) {
+            const auto box = TileParams::drawn_box(chunk.tile(slot));
+            left = std::min(left, box.x);
+            top = std::min(top, box.y);
+            right = std::max(right, box.x + box.width);
+            bottom = std::max(bottom, box.y + box.height);
+        });
+    }
+    if (left > right)
+        return;
+    bounds.set(left - MARGIN, top - MARGIN, right - left + 2 * MARGIN, bottom - top + 2 * MARGIN);
+}
+
+std::uint8_t PosterExport::Band::at(const TileCoord &coord) const
+{
+    if (coord.row < rows.begin or coord.row >= rows.end or coord.col < cols.begin or coord.col >= cols.end)
+        return 0;
+    return tiles[size_t(coord.row - rows.begin) * (cols.end - cols.begin) + (coord.col - cols.begin)];
+}
+
+void PosterExport::loadBand(Band &band, float top, float bottom) const
+{
+    // the neighbours of the tiles in the band are looked at for the outlines
+    band.rows = TileParams::row_range(top, bottom);
+    band.rows.begin -= 2;
+    band.rows.end += 2;
+    band.cols = TileParams::col_range(bounds.x, bounds.x + bounds.width);
+    band.cols.begin -= 1;
+    band.cols.end += 1;
+
+    const size_t rowLength = band.cols.end - band.cols.begin;
+    band.tiles.assign(size_t(band.rows.end - band.rows.begin) * rowLength, 0);
+
+    ChunkCoord cached { 0, 0 };
+    const std::uint8_t *chunk = floor.find(cached);
+    auto *state = band.tiles.data();
+    for (int row = band.rows.begin; row < band.rows.end; ++row) {
+        for (int col = band.cols.begin; col < band.cols.end; ++col, ++state) {
+            const TileCoord coord { row, col };
+            const auto chunkCoord = ChunkCoord::of(coord);
+            if (chunkCoord != cached) {
+                cached = chunkCoord;
+                chunk = floor.find(cached);
+            }
+            const auto slot = ChunkCoord::slot(coord);
+            unsigned color, orientation;
+            if (chunk != nullptr) {
+                if (ChunkBits::enabled(chunk, slot))
+                    *state = std::uint8_t(ENABLED | ChunkBits::color(chunk, slot) << 2 | ChunkBits::orientation(chunk, slot));
+            } else if (floor.getPattern().tile(coord, color, orientation)) {
+                *state = std::uint8_t(ENABLED | color << 2 | orientation);
+            }
+        }
+    }
+}
+
+// an edge between two enabled tiles is drawn twice
+float PosterExport::outlineAlpha(const Band &band, const ofVec2f &p, float pixel, float alpha)
+{
+    const auto coord = TileParams::coord_at(p.x, p.y);
+    const auto center = TileParams::center(coord);
+    const auto local = p - center;
+    const bool enabled = band.at(coord) != 0;
+
+    float result = 0;
+    for (int k = 0; k < 6; ++k) {
+        const float distance = TileParams::row_height - (local.x * EDGE_NX[k] + local.y * EDGE_NY[k]);
+        if (distance >= HALF_LINE + pixel)
+            continue;
+        const ofVec2f across(center.x + EDGE_NX[k] * 2 * TileParams::row_height,
+                             center.y + EDGE_NY[k] * 2 * TileParams::row_height);
+        const unsigned count = enabled + (band.at(TileParams::coord_at(across.x, across.y)) != 0);
+        if (count == 0)
+            continue;
+        result = std::max(result, coverage(distance, pixel) * (count == 2 ? doubleAlpha(alpha) : alpha));
+    }
+    return result;
+}
+
+// opacity of the cube lines of a tile at local, relative to its center
+static float cubeAlpha(unsigned orientation, const ofVec2f &local, float pixel)
+{
+    if (orientation == 0)
+        return 0;
+    float distance = INFINITY;
+    for (int i = orientation == 1 ? 1 : 0; i < 6; i += 2) {
+        const ofVec2f vertex(TileParams::vertex_x[i], TileParams::vertex_y[i]);
+        const float t = std::min(std::max(local.dot(vertex) / vertex.lengthSquared(), 0.f), 1.f);
+        distance = std::min(distance, (local - vertex * t).length());
+    }
+    return coverage(distance, pixel) * doubleAlpha(LINE_ALPHA);
+}
+
+static Rgb sample(const ofPixels &image, float u, float v)
+{
+    const auto *data = image.getData();
+    const int w = (int) image.getWidth();
+    const int h = (int) image.getHeight();
+    const int channels = (int) image.getNumChannels();
+
+    const float x = std::min(std::max(u * w - 0.5f, 0.f), float(w - 1));
+    const float y = std::min(std::max(v * h - 0.5f, 0.f), float(h - 1));
+    const int x0 = (int) x, y0 = (int) y;
+    const int x1 = std::min(x0 + 1, w - 1), y1 = std::min(y0 + 1, h - 1);
+    const float fx = x - x0, fy = y - y0;
+
+    float rgb[3];
+    for (int c = 0; c < 3; ++c) {
+        const int channel = std::min(c, channels - 1);
+        const auto at = [&](int px, int py) { return data[(size_t(py) * w + px) * channels + channel] / 255.f; };
+        const float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * fx;
+        const float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * fx;
+        rgb[c] = top + (bottom - top) * fy;
+    }
+    return Rgb { rgb[0], rgb[1], rgb[2] };
+}
+
+void PosterExport::renderRows(std::uint8_t *rgb, std::uint32_t firstRow, unsigned rows, std::uint32_t columns, float dpi) const
+{
+    const float pixel = 1 / scale(dpi);
+    const float top = bounds.y + firstRow * pixel;
+
+    Band band;
+    loadBand(band, top - LINE_WIDTH_PIX, top + rows * pixel + LINE_WIDTH_PIX);
+
+    const ofVec2f shadowOffset(HALF_LINE, HALF_LINE);
+
+    for (unsigned row = 0; row < rows; ++row) {
+        const float y = top + (row + 0.5f) * pixel;
+        for (std::uint32_t col = 0; col < columns; ++col, rgb += 3) {
+            const ofVec2f p(bounds.x + (col + 0.5f) * pixel, y);
+            Rgb color { 1, 1, 1 };
+
+            color.blend(0, outlineAlpha(band, p - shadowOffset, pixel, SHADOW_ALPHA));
+
+            const auto coord = TileParams::coord_at(p.x, p.y);
+            const auto state = band.at(coord);
+            const auto local = p - TileParams::center(coord);
+            if (state & ENABLED) {
+                const unsigned fill = state >> 2 & 3;
+                const auto &image = images[std::min(fill, 2u)];
+                if (image.isAllocated()) {
+                    const float u = (local.x + TileParams::radius) / (2 * TileParams::radius);
+                    const float v = (local.y + TileParams::row_height) / (2 * TileParams::row_height);
+                    color.blend(sample(image, u, v), 1);
+                } else {
+                    color.blend(FLAT_FILLS[std::min(fill, 2u)], 1);
+                }
+            }
+
+            color.blend(LINE_GRAY, outlineAlpha(band, p, pixel, LINE_ALPHA));
+            if (state & ENABLED)
+                color.blend(LINE_GRAY, cubeAlpha(state & 3, local, pixel));
+
+            rgb[0] = byte(color.r);
+            rgb[1] = byte(color.g);
+            rgb[2] = byte(color.b);
+        }
+    }
+}
+
+bool PosterExport::write(const std::string &path, float dpi, WorkerPool &pool) const
+{
+    const auto w = width(dpi);
+    const auto h = height(dpi);
+    if (w == 0 or h == 0)
+        return false;
+
+    PngWriter png;
+    if (not png.open(path, w, h, dpi))
+        return false;
+
+    const size_t rowBytes = size_t(w) * 3;
+    const auto bandRows = (std::uint32_t) std::min<size_t>(std::max<size_t>(BAND_BYTES / rowBytes, 1), h);
+    const unsigned bands = pool.size();
+    std::vector<std::uint8_t> buffer(size_t(bandRows) * bands * rowBytes);
+
+    for (std::uint32_t first = 0; first < h; first += bandRows * bands) {
+        const auto rows = std::min<std::uint32_t>(h - first, bandRows * bands);
+        pool.parallel_for((rows + bandRows - 1) / bandRows, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto row = std::uint32_t(i * bandRows);
+                renderRows(buffer.data() + row * rowBytes, first + row, std::min(bandRows, rows - row), w, dpi);
+            }
+        });
+        if (not png.writeRows(buffer.data(), rows))
+            return false;
+    }
+    return png.close();
+}
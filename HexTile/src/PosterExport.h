@@ -0,0 +1,95 @@
+/*
+ * PosterExport.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_POSTEREXPORT_H_
+#define SRC_POSTEREXPORT_H_
+
+#include "FloorFile.h"
+#include "TileCoord.h"
+#include "TileParams.h"
+#include "WorkerPool.h"
+
+#include <ofPixels.h>
+#include <ofRectangle.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Prints a saved floor design into a PNG at any resolution, without a window or a GPU.
+// The image is cut into bands of rows that are rasterized on the CPU by all threads
+// of the pool and written out in order as they are done, so the memory used only
+// depends on the width of the image.
+// Tiles are drawn the same way as on screen: shadow, fill, outline and cube lines.
+class PosterExport
+{
+public:
+    // bytes of the bands rendered at once, per thread
+    static constexpr size_t BAND_BYTES = 8 << 20;
+    // white paper around the tiles, in view units
+    static constexpr float MARGIN = 2 * TileParams::radius;
+
+    explicit PosterExport(const FloorFile &floor);
+
+    // the fills are flat colours if the images of the tiles are not loaded
+    bool loadImages(const std::string &dir);
+
+    // the drawn tiles of the saved chunks and the margin in view units, empty if no tile is enabled;
+    // a design on a pattern goes on without end, its bounds stay empty until setArea is called
+    const ofRectangle &getBounds() const
+    {
+        return bounds;
+    }
+
+    // prints area, in view units, instead of the bounds of the tiles
+    void setArea(const ofRectangle &area)
+    {
+        bounds = area;
+    }
+
+    bool isPatterned() const
+    {
+        return !floor.getPattern().isNone();
+    }
+
+    // pixels of the poster at dpi
+    std::uint32_t width(float dpi) const;
+    std::uint32_t height(float dpi) const;
+
+    bool write(const std::string &path, float dpi, WorkerPool &pool = WorkerPool::shared()) const;
+
+private:
+    // a band of tiles rows with the state of the tiles needed to draw it
+    struct Band
+    {
+        TileParams::IntRange rows;
+        TileParams::IntRange cols;
+        // ENABLED | color << 2 | orientation, row by row
+        std::vector<std::uint8_t> tiles;
+
+        std::uint8_t at(const TileCoord &coord) const;
+    };
+
+    static constexpr std::uint8_t ENABLED = 0x80;
+
+    static float scale(float dpi);
+    // opacity at p of the outlines of the enabled tiles
+    static float outlineAlpha(const Band &band, const ofVec2f &p, float pixel, float alpha);
+
+    void findBounds();
+    void loadBand(Band &band, float top, float bottom) const;
+    void renderRows(std::uint8_t *rgb, std::uint32_t firstRow, unsigned rows, std::uint32_t columns, float dpi) const;
+
+    const FloorFile &floor;
+    ofRectangle bounds;
+
+    // indexed by TileColor
+    std::array<ofPixels, 3> images;
+};
+
+#endif /* SRC_POSTEREXPORT_H_ */
@@ -0,0 +1,92 @@
+/*
+ * RegionSelection.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "RegionSelection.h"
+
+#include <ciso646>
+
+#include <algorithm>
+#include <cmath>
+
+RegionSelection::RegionSelection(const ofRectangle &rect) :
+    RegionSelection(std::vector<ofVec2f> {
+        { rect.getLeft(), rect.getTop() },
+        { rect.getRight(), rect.getTop() },
+        { rect.getRight(), rect.getBottom() },
+        { rect.getLeft(), rect.getBottom() },
+    })
+{
+}
+
+RegionSelection::RegionSelection(std::vector<ofVec2f> outline) :
+    outline(std::move(outline))
+{
+    const auto &points = this->outline;
+    if (points.size() < 3)
+        return;
+
+    float top = points[0].y, bottom = points[0].y;
+    for (const auto &point : points) {
+        top = std::min(top, point.y);
+        bottom = std::max(bottom, point.y);
+    }
+
+    // even-odd rule along the centre line of each row
+    std::vector<float> crossings;
+    const auto rows = TileParams::row_range(top, bottom);
+    for (int row = rows.begin; row <= rows.end; ++row) {
+        const float y = TileParams::center(row, 0).y;
+        crossings.clear();
+        for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+            const auto &a = points[j];
+            const auto &b = points[i];
+            // half-open, so a vertex on the line is crossed once
+            if ((a.y <= y) != (b.y <= y))
+                crossings.push_back(a.x + (y - a.y) / (b.y - a.y) * (b.x - a.x));
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2)
+            addSpan(row, crossings[i], crossings[i + 1]);
+    }
+}
+
+void RegionSelection::addSpan(int row, float left, float right)
+{
+    // the columns whose centre is in [left, right]
+    const float offset = TileParams::center(row, 0).x;
+    const int first = (int) std::ceil((left - offset) / TileParams::col_width);
+    const int last = (int) std::floor((right - offset) / TileParams::col_width);
+    if (first > last)
+        return;
+    spans.push_back(Span { row, first, std::uint32_t(last - first + 1) });
+    tiles += spans.back().count;
+}
+
+bool RegionSelection::contains(const TileCoord &coord) const
+{
+    // the first span after coord
+    const auto after = std::upper_bound(spans.begin(), spans.end(), coord, [](const TileCoord &coord, const Span &span) {
+        return coord.row < span.row or (coord.row == span.row and coord.col < span.col);
+    });
+    if (after == spans.begin())
+        return false;
+    const auto &span = *(after - 1);
+    return span.row == coord.row and coord.col < span.col + (int) span.count;
+}
+
+TileParams::TileRange RegionSelection::range() const
+{
+    if (spans.empty())
+        return TileParams::TileRange { { 0, -1 }, { 0, -1 } };
+
+    int left = spans.front().col, right = left;
+    for (const auto &span : spans) {
+        left = std::min(left, span.col);
+        right = std::max(right, span.col + (int) span.count - 1);
+    }
+    return TileParams::TileRange { { spans.front().row, spans.back().row }, { left, right } };
+}
@@ -0,0 +1,84 @@
+/*
+ * RegionSelection.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_REGIONSELECTION_H_
+#define SRC_REGIONSELECTION_H_
+
+#include "TileCoord.h"
+#include "TileParams.h"
+
+#include <ofRectangle.h>
+#include <ofVec2f.h>
+
+#include <cstdint>
+#include <vector>
+
+// The tiles whose centre lies inside a rectangle or a freehand outline.
+// Kept as runs of tiles along the rows, a few bytes per row however many
+// tiles are selected. The runs are found row by row where the outline
+// crosses the centre line of the row, so no tile is tested on its own.
+class RegionSelection
+{
+public:
+    // tiles (row, col) to (row, col + count - 1)
+    struct Span
+    {
+        std::int32_t row;
+        std::int32_t col;
+        std::uint32_t count;
+    };
+
+    RegionSelection() = default;
+    // in view coordinates
+    explicit RegionSelection(const ofRectangle &rect);
+    // a closed outline, in view coordinates
+    explicit RegionSelection(std::vector<ofVec2f> outline);
+
+    bool empty() const
+    {
+        return spans.empty();
+    }
+
+    // number of selected tiles
+    size_t size() const
+    {
+        return tiles;
+    }
+
+    bool contains(const TileCoord &coord) const;
+
+    // the rows and columns of the selected tiles
+    TileParams::TileRange range() const;
+
+    // sorted by row, then column
+    const std::vector<Span> &getSpans() const
+    {
+        return spans;
+    }
+
+    const std::vector<ofVec2f> &getOutline() const
+    {
+        return outline;
+    }
+
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (const auto &span : spans)
+            for (std::uint32_t i = 0; i < span.count; ++i)
+                f(TileCoord { span.row, span.col + (int) i });
+    }
+
+private:
+    void addSpan(int row, float left, float right);
+
+    std::vector<ofVec2f> outline;
+    std::vector<Span> spans;
+    size_t tiles = 0;
+};
+
+#endif /* SRC_REGIONSELECTION_H_ */
@@ -55,10 +55,10 @@ void Sticky::adjustDirection(const Tile& tile)
     };
 
     if (tile.isVisible()) {
-        if (tile.orientation == Orientation::Even) {
+        if (tile.orientation() == Orientation::Even) {
             adjust_by_closest_vertex_index({1,3,5});
 
-        } else if(tile.orientation == Orientation::Odd) {
+        } else if(tile.orientation() == Orientation::Odd) {
             adjust_by_closest_vertex_index({0,2,4});
         } else {
             direction = -1;
@@ -16,7 +16,7 @@
 #include <vector>
 #include <complex>
 
-struct Tile;
+class Tile;
 
 static constexpr auto STEP_DURATION = 200ms;
 
@@ -8,177 +8,228 @@
 #define SRC_TILE_H_
 
 #include "Clock.h"
+#include "TileCoord.h"
+#include "TileParams.h"
+#include "TileRandom.h"
+#include "TileStore.h"
 
 #include <ofImage.h>
-#include <ofPolyline.h>
 
 #include <cmath>
 #include <vector>
-#include <tuple>
 
 
 struct TileImages
 {
     ofImage black, grey, white;
 };
-enum class TileColor
-{
-    Black,
-    Gray,
-    White,
-};
 
-enum class Orientation
+// Reference to the state of a tile kept in a TileStore.
+// Cheap to copy, pass it by value.
+class Tile
 {
-    Blank = 0,
-    Odd = 1,
-    Even = 2,
-};
+public:
+    Tile(TileStore &store, TileId id) :
+        store(&store),
+        id(id)
+    {
+    }
 
-// for flood fill
-using TileState = std::tuple<bool, TileColor, Orientation>;
+    TileId getId() const
+    {
+        return id;
+    }
 
-struct Tile
-{
-    TileColor color = TileColor::White;
-    Orientation orientation = Orientation::Blank;
-    bool enabled = false;
+    TileColor color() const
+    {
+        return store->color(id);
+    }
+    void setColor(TileColor color)
+    {
+        store->setColor(id, color);
+    }
+
+    Orientation orientation() const
+    {
+        return store->orientation(id);
+    }
+    void setOrientation(Orientation orientation)
+    {
+        store->setOrientation(id, orientation);
+    }
 
-    float alpha = 0;
-    float initial_alpha = 0;
-    TimeStamp alpha_start;
-    TimeStamp alpha_stop;
-    bool in_transition = false;
+    bool enabled() const
+    {
+        return store->isEnabled(id);
+    }
+    bool in_transition() const
+    {
+        return store->isInTransition(id);
+    }
+    float alpha() const
+    {
+        return store->alpha(id);
+    }
 
     bool isVisible() const
     {
-        return enabled || in_transition;
+        return enabled() || in_transition();
     }
 
-    bool update_alpha(const TimeStamp &now);
     void start_enabling(const TimeStamp &now);
     void start_disabling(const TimeStamp &now);
 
     void fill() const;
-    void fill(TileImages &) const;
     void draw() const;
-    void drawCubeIllusion();
     bool removeOrientation()
     {
-        if (orientation == Orientation::Blank)
+        if (orientation() == Orientation::Blank)
             return false;
-        orientation = Orientation::Blank;
+        setOrientation(Orientation::Blank);
         return true;
     }
 
     void changeOrientationUp()
     {
-        orientation = (orientation == Orientation::Blank ? Orientation::Even : (Orientation) (3 - (int) orientation));
+        const auto o = orientation();
+        setOrientation(o == Orientation::Blank ? Orientation::Even : (Orientation) (3 - (int) o));
     }
     void changeOrientationDown()
     {
-        orientation = (orientation == Orientation::Blank ? Orientation::Odd : (Orientation) (3 - (int) orientation));
+        const auto o = orientation();
+        setOrientation(o == Orientation::Blank ? Orientation::Odd : (Orientation) (3 - (int) o));
     }
 
-    Tile(float x, float y, float radius);
     bool isPointInside(float x, float y) const;
 
-    void changeToRandomColor(const TimeStamp &now)
+    // the random choices are as likely as rounding a uniform number in [0, 2)
+    void changeToRandomColor(const TimeStamp &now, const TileRandom &random)
     {
-        color = (TileColor) (int) roundf(ofRandom(2));
-        if (!enabled) {
-            if (!in_transition)
-                orientation = Orientation::Blank;
+        setColor((TileColor) (int) roundf(2 * random.uniform(getCoord())));
+        if (!enabled()) {
+            if (!in_transition())
+                setOrientation(Orientation::Blank);
             start_enabling(now);
         }
     }
-    void changeToRandomOrientation()
+    void changeToRandomOrientation(const TileRandom &random)
     {
-        orientation = (Orientation) (int) roundf(ofRandom(2));
+        setOrientation((Orientation) (int) roundf(2 * random.uniform(getCoord())));
     }
-    void changeToRandomNonBlankOrientation()
+    void changeToRandomNonBlankOrientation(const TileRandom &random)
     {
-        orientation = (Orientation) (1 + (int) roundf(ofRandom(1)));
+        setOrientation((Orientation) (1 + (int) roundf(random.uniform(getCoord()))));
     }
     void changeColorUp(const TimeStamp &now)
     {
-        if (!enabled) {
-            if (!in_transition) {
-                color = TileColor::White;
-                orientation = Orientation::Blank;
+        if (!enabled()) {
+            if (!in_transition()) {
+                setColor(TileColor::White);
+                setOrientation(Orientation::Blank);
             }
 
             start_enabling(now);
             return;
         }
-        color = (TileColor) (((int) color + 1) % 3);
+        setColor((TileColor) (((int) color() + 1) % 3));
     }
     void changeColorDown(const TimeStamp &now)
     {
-        if (!enabled) {
-            if (!in_transition) {
-                color = TileColor::Black;
-                orientation = Orientation::Blank;
+        if (!enabled()) {
+            if (!in_transition()) {
+                setColor(TileColor::Black);
+                setOrientation(Orientation::Blank);
             }
             start_enabling(now);
             return;
         }
-        color = (TileColor) (((int) color + 2) % 3);
+        setColor((TileColor) (((int) color() + 2) % 3));
     }
     void invertColor()
     {
-        if (!enabled) {
-            enabled = true;
+        if (!enabled()) {
+            store->setEnabled(id, true);
             return;
         }
-        color = (TileColor) (2 - (int) color);
+        setColor((TileColor) (2 - (int) color()));
     }
 
     float squareDistanceFromVertex(const ofVec2f &pt, int i) const
     {
-        return ofVec2f { vertices[i].x, vertices[i].y }.squareDistance(pt);
+        return TileParams::vertex(getCoord(), i).squareDistance(pt);
     }
     float squareDistanceFromCenter(const ofVec2f &pt) const
     {
-        return center.squareDistance(pt);
+        return TileParams::center(getCoord()).squareDistance(pt);
     }
 
     float radiusSquared() const
     {
-        return radius * radius;
-    }
-
-    TileState getStateForFloodFill()
-    {
-        if (!isVisible())
-            return TileState(false, TileColor::White, Orientation::Blank);
-        return TileState(true, color, orientation);
+        return TileParams::radius * TileParams::radius;
     }
 
-    void connectIfNeighbour(Tile *other);
-    void disconnect();
-
-    const std::vector<Tile *>& getNeighbours()
+    const TileCoord &getCoord() const
     {
-        return neighbours;
+        return store->coord(id);
     }
 
     bool isInRect(const ofRectangle &rect) const
     {
-        return rect.intersects(box);
+        return rect.intersects(TileParams::box(getCoord()));
     }
 private:
-    ofPolyline vertices;
-    ofVec2f center;
-    float radius;
-    ofRectangle box;
+    TileStore *store;
+    TileId id;
+};
+
+// Iterates over a list of tile ids, yielding Tile references
+class TileList
+{
+public:
+    class iterator
+    {
+    public:
+        iterator(TileStore *store, std::vector<TileId>::const_iterator it) :
+            store(store),
+            it(it)
+        {
+        }
+        Tile operator *() const
+        {
+            return Tile(*store, *it);
+        }
+        iterator &operator ++()
+        {
+            ++it;
+            return *this;
+        }
+        bool operator !=(const iterator &other) const
+        {
+            return it != other.it;
+        }
+    private:
+        TileStore *store;
+        std::vector<TileId>::const_iterator it;
+    };
 
-    std::vector<Tile *> neighbours;
+    TileList(TileStore &store, const std::vector<TileId> &ids) :
+        store(&store),
+        ids(&ids)
+    {
+    }
 
-    bool isDisabling()
+    iterator begin() const
+    {
+        return iterator(store, ids->begin());
+    }
+    iterator end() const
     {
-        return in_transition && !enabled;
+        return iterator(store, ids->end());
     }
+
+private:
+    TileStore *store;
+    const std::vector<TileId> *ids;
 };
 
 #endif /* SRC_TILE_H_ */
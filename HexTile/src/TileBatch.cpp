@@ -0,0 +1,264 @@
+/*
+ * TileBatch.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "TileBatch.h"
+#include "TileParams.h"
+#include "AppConsts.h"
+
+#include <ofGraphics.h>
+
+#include <ciso646>
+
+static constexpr unsigned HEXAGON_VERTICES = 6;
+static constexpr unsigned QUAD_VERTICES = 4;
+static constexpr unsigned CUBE_VERTICES = 4;
+
+// b == a * ( 1 - alpha ) + x * alpha
+// c == b * ( 1 - alpha ) + x * alpha
+//   == (a * ( 1 - alpha ) + x * alpha) * (1 - alpha) + x * alpha
+//   == a * (1 - (2*alpha - alpha^2) ) + x * (2*alpha - alpha^2)
+static float doubleAlpha(float alpha)
+{
+    return 2 * alpha - alpha * alpha;
+}
+
+static ofFloatColor fillColor(unsigned color, bool textured, float alpha)
+{
+    if (textured)
+        return ofFloatColor(1, 1, 1, alpha);
+    switch ((TileColor) color) {
+    case TileColor::Black:
+        return ofFloatColor(2 / 255.f, 2 / 255.f, 2 / 255.f, alpha);
+    case TileColor::Gray:
+        return ofFloatColor(96 / 255.f, 96 / 255.f, 96 / 255.f, alpha);
+    case TileColor::White:
+    default:
+        return ofFloatColor(1, 1, 1, alpha);
+    }
+}
+
+static ofFloatColor shadowColor(float alpha)
+{
+    return ofFloatColor(0, 0, 0, 128 / 255.f * alpha);
+}
+
+static ofFloatColor lineColor(float alpha)
+{
+    return ofFloatColor(20 / 255.f, 20 / 255.f, 20 / 255.f, alpha * 160 / 255);
+}
+
+// cube lines are drawn over the outline, as if drawn 2 times
+static ofFloatColor cubeColor(float alpha)
+{
+    return ofFloatColor(20 / 255.f, 20 / 255.f, 20 / 255.f, doubleAlpha(alpha * 160 / 255));
+}
+
+static unsigned lineVertexCount(Orientation orientation)
+{
+    return HEXAGON_VERTICES + (orientation != Orientation::Blank ? CUBE_VERTICES : 0);
+}
+
+static void addHexagon(ofMesh &mesh, const ofVec2f &center, const ofFloatColor &color, bool outline)
+{
+    const auto first = (unsigned) mesh.getNumVertices();
+    for (unsigned i = 0; i < HEXAGON_VERTICES; ++i) {
+        mesh.addVertex(ofVec3f(TileParams::vertex(center, i)));
+        mesh.addColor(color);
+    }
+    if (outline) {
+        for (unsigned i = 0; i < HEXAGON_VERTICES; ++i) {
+            mesh.addIndex(first + i);
+            mesh.addIndex(first + (i + 1) % HEXAGON_VERTICES);
+        }
+    } else {
+        for (unsigned i = 1; i + 1 < HEXAGON_VERTICES; ++i) {
+            mesh.addIndex(first);
+            mesh.addIndex(first + i);
+            mesh.addIndex(first + i + 1);
+        }
+    }
+}
+
+static void addQuad(ofMesh &mesh, const ofRectangle &box, const ofVec2f &texMax, const ofFloatColor &color)
+{
+    const auto first = (unsigned) mesh.getNumVertices();
+    mesh.addVertex(ofVec3f(box.x, box.y));
+    mesh.addVertex(ofVec3f(box.x + box.width, box.y));
+    mesh.addVertex(ofVec3f(box.x + box.width, box.y + box.height));
+    mesh.addVertex(ofVec3f(box.x, box.y + box.height));
+    mesh.addTexCoord(ofVec2f(0, 0));
+    mesh.addTexCoord(ofVec2f(texMax.x, 0));
+    mesh.addTexCoord(ofVec2f(texMax.x, texMax.y));
+    mesh.addTexCoord(ofVec2f(0, texMax.y));
+    for (unsigned i = 0; i < QUAD_VERTICES; ++i)
+        mesh.addColor(color);
+    for (unsigned i : { 0, 1, 2, 0, 2, 3 })
+        mesh.addIndex(first + i);
+}
+
+static void addCube(ofMesh &mesh, const ofVec2f &center, Orientation orientation, const ofFloatColor &color)
+{
+    if (orientation == Orientation::Blank)
+        return;
+    const auto first = (unsigned) mesh.getNumVertices();
+    const int start = orientation == Orientation::Odd ? 1 : 0;
+    mesh.addVertex(ofVec3f(center));
+    mesh.addColor(color);
+    for (int i = start; i < 6; i += 2) {
+        mesh.addVertex(ofVec3f(TileParams::vertex(center, i)));
+        mesh.addColor(color);
+        mesh.addIndex(first);
+        mesh.addIndex((unsigned) mesh.getNumVertices() - 1);
+    }
+}
+
+void TileBatch::setImages(TileImages *images)
+{
+    this->images = images;
+    built = false;
+}
+
+ofImage *TileBatch::image(TileColor color) const
+{
+    if (images == nullptr)
+        return nullptr;
+    switch (color) {
+    case TileColor::Black:
+        return &images->black;
+    case TileColor::Gray:
+        return &images->grey;
+    case TileColor::White:
+        return &images->white;
+    }
+    return nullptr;
+}
+
+bool TileBatch::update(const TileStore &tiles, const std::vector<TileId> &viewable, std::uint64_t viewableChanges)
+{
+    if (not built or builtEdits != tiles.editCount() or builtViewable != viewableChanges) {
+        build(tiles, viewable);
+        builtViewable = viewableChanges;
+        return true;
+    }
+    // one more pass after the last fade ended, to pick up the final alphas
+    if (tiles.transitionCount() != 0 or wasFading) {
+        recolor(tiles);
+        return true;
+    }
+    return false;
+}
+
+void TileBatch::build(const TileStore &tiles, const std::vector<TileId> &viewable)
+{
+    for (unsigned c = 0; c < fills.size(); ++c) {
+        const auto *img = image((TileColor) c);
+        texCoordMax[c] = img != nullptr and img->isAllocated()
+            ? img->getTexture().getCoordFromPercent(1, 1)
+            : ofVec2f(0, 0);
+
+        fills[c].clear();
+        fills[c].setMode(OF_PRIMITIVE_TRIANGLES);
+        fills[c].setUsage(GL_DYNAMIC_DRAW);
+        fillTiles[c].clear();
+    }
+    for (auto *mesh : { &shadows, &lines }) {
+        mesh->clear();
+        mesh->setMode(OF_PRIMITIVE_LINES);
+        mesh->setUsage(GL_DYNAMIC_DRAW);
+    }
+    lineTiles.clear();
+
+    const ofVec2f shadowOffset(LINE_WIDTH_PIX / 2, LINE_WIDTH_PIX / 2);
+
+    for (auto id : viewable) {
+        if (not tiles.isEnabled(id) and not tiles.isInTransition(id))
+            continue;
+        const auto coord = tiles.coord(id);
+        const auto center = TileParams::center(coord);
+        const auto alpha = tiles.alpha(id);
+
+        const auto color = (unsigned) tiles.color(id);
+        if (isTextured(color))
+            addQuad(fills[color], TileParams::box(coord), texCoordMax[color], fillColor(color, true, alpha));
+        else
+            addHexagon(fills[color], center, fillColor(color, false, alpha), false);
+        fillTiles[color].push_back(id);
+
+        addHexagon(shadows, center + shadowOffset, shadowColor(alpha), true);
+        addHexagon(lines, center, lineColor(alpha), true);
+        addCube(lines, center, tiles.orientation(id), cubeColor(alpha));
+        lineTiles.push_back(id);
+    }
+
+    built = true;
+    builtEdits = tiles.editCount();
+    wasFading = tiles.transitionCount() != 0;
+}
+
+void TileBatch::recolor(const TileStore &tiles)
+{
+    for (unsigned c = 0; c < fills.size(); ++c) {
+        const bool textured = isTextured(c);
+        const unsigned count = textured ? QUAD_VERTICES : HEXAGON_VERTICES;
+        auto *color = fills[c].getColors().data();
+        for (auto id : fillTiles[c]) {
+            const auto value = fillColor(c, textured, tiles.alpha(id));
+            for (unsigned i = 0; i < count; ++i)
+                *color++ = value;
+        }
+    }
+
+    auto *shadow = shadows.getColors().data();
+    auto *line = lines.getColors().data();
+    for (auto id : lineTiles) {
+        const auto alpha = tiles.alpha(id);
+        const auto outline = lineColor(alpha);
+        const auto cube = cubeColor(alpha);
+        for (unsigned i = 0; i < HEXAGON_VERTICES; ++i) {
+            *shadow++ = shadowColor(alpha);
+            *line++ = outline;
+        }
+        for (unsigned i = HEXAGON_VERTICES; i < lineVertexCount(tiles.orientation(id)); ++i)
+            *line++ = cube;
+    }
+
+    wasFading = tiles.transitionCount() != 0;
+}
+
+void TileBatch::draw(float zoom) const
+{
+    ofSetLineWidth(LINE_WIDTH_PIX * zoom);
+    drawShadows();
+    drawFills();
+    drawLines();
+}
+
+void TileBatch::drawShadows() const
+{
+    shadows.draw();
+}
+
+void TileBatch::drawFills() const
+{
+    for (unsigned c = 0; c < fills.size(); ++c) {
+        if (fillTiles[c].empty())
+            continue;
+        if (isTextured(c)) {
+            const auto &texture = image((TileColor) c)->getTexture();
+            texture.bind();
+            fills[c].draw();
+            texture.unbind();
+        } else {
+            fills[c].draw();
+        }
+    }
+}
+
+void TileBatch::drawLines() const
+{
+    lines.draw();
+}
@@ -0,0 +1,87 @@
+/*
+ * TileBatch.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_TILEBATCH_H_
+#define SRC_TILEBATCH_H_
+
+#include "Tile.h"
+#include "TileStore.h"
+
+#include <ofVboMesh.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Vertex buffers with every visible tile of the view: the shadows, one
+// fill mesh per tile colour and one mesh with the outlines and cube lines.
+// The frame buffer is drawn with five draw calls however many tiles there are.
+// The meshes are rebuilt only when a tile or the list of viewable tiles
+// changed; while tiles fade only the vertex colours are rewritten.
+// Building does not need a GL context.
+class TileBatch
+{
+public:
+    // fills use the images if they are loaded, flat colours otherwise
+    void setImages(TileImages *images);
+
+    // brings the meshes up to date; returns true if they changed.
+    // viewableChanges has to change whenever the list of viewable tiles does
+    bool update(const TileStore &tiles, const std::vector<TileId> &viewable, std::uint64_t viewableChanges);
+
+    void build(const TileStore &tiles, const std::vector<TileId> &viewable);
+    void recolor(const TileStore &tiles);
+
+    // shadows, fills, then lines, with the line width scaled by zoom
+    void draw(float zoom) const;
+
+    // the line width is set by the caller
+    void drawShadows() const;
+    void drawFills() const;
+    void drawLines() const;
+
+    const ofMesh &shadowMesh() const
+    {
+        return shadows;
+    }
+
+    const ofMesh &fillMesh(TileColor color) const
+    {
+        return fills[(unsigned) color];
+    }
+
+    const ofMesh &lineMesh() const
+    {
+        return lines;
+    }
+
+private:
+    ofImage *image(TileColor color) const;
+    bool isTextured(unsigned color) const
+    {
+        return texCoordMax[color].x != 0;
+    }
+
+    TileImages *images = nullptr;
+
+    // indexed by TileColor
+    std::array<ofVboMesh, 3> fills;
+    std::array<std::vector<TileId>, 3> fillTiles;
+    std::array<ofVec2f, 3> texCoordMax;
+
+    ofVboMesh shadows;
+    ofVboMesh lines;
+    // tiles of shadows and lines in the order of their vertices
+    std::vector<TileId> lineTiles;
+
+    bool built = false;
+    bool wasFading = false;
+    std::uint64_t builtEdits = 0;
+    std::uint64_t builtViewable = 0;
+};
+
+#endif /* SRC_TILEBATCH_H_ */
@@ -0,0 +1,127 @@
+/*
+ * TileChunk.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_TILECHUNK_H_
+#define SRC_TILECHUNK_H_
+
+#include "PackedBits.h"
+#include "TileCoord.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// The grid is cut into chunks of CHUNK_ROWS x CHUNK_COLS tiles.
+// Rows are much closer to each other than columns,
+// so a chunk of 128 x 32 tiles is roughly square on screen.
+constexpr int CHUNK_ROW_BITS = 7;
+constexpr int CHUNK_COL_BITS = 5;
+constexpr int CHUNK_ROWS = 1 << CHUNK_ROW_BITS;
+constexpr int CHUNK_COLS = 1 << CHUNK_COL_BITS;
+constexpr unsigned CHUNK_TILES = CHUNK_ROWS * CHUNK_COLS;
+
+struct ChunkCoord
+{
+    int row;
+    int col;
+
+    // arithmetic shift rounds towards negative infinity
+    static ChunkCoord of(const TileCoord &coord)
+    {
+        return ChunkCoord { coord.row >> CHUNK_ROW_BITS, coord.col >> CHUNK_COL_BITS };
+    }
+
+    // position of a tile inside its chunk
+    static unsigned slot(const TileCoord &coord)
+    {
+        return (coord.row & (CHUNK_ROWS - 1)) << CHUNK_COL_BITS | (coord.col & (CHUNK_COLS - 1));
+    }
+
+    TileCoord tile(unsigned slot) const
+    {
+        return TileCoord { row * CHUNK_ROWS + int(slot >> CHUNK_COL_BITS),
+                           col * CHUNK_COLS + int(slot & (CHUNK_COLS - 1)) };
+    }
+
+    bool operator ==(const ChunkCoord &other) const
+    {
+        return row == other.row && col == other.col;
+    }
+
+    bool operator !=(const ChunkCoord &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator <(const ChunkCoord &other) const
+    {
+        return row < other.row || (row == other.row && col < other.col);
+    }
+};
+
+namespace std {
+
+template<>
+struct hash<ChunkCoord>
+{
+    size_t operator()(const ChunkCoord &coord) const
+    {
+        return hash<TileCoord>()(TileCoord { coord.row, coord.col });
+    }
+};
+
+} // namespace std
+
+// The state of the tiles of a chunk as it is saved:
+// 2 bits of colour, 2 bits of orientation and 1 enabled bit per tile, in three planes.
+// Bytes only, so that it reads the same on every platform and can be used
+// straight from a mapped file.
+namespace ChunkBits {
+
+constexpr size_t COLOR_BYTES = CHUNK_TILES / 4;
+constexpr size_t ORIENTATION_BYTES = CHUNK_TILES / 4;
+constexpr size_t ENABLED_BYTES = CHUNK_TILES / 8;
+constexpr size_t SIZE = COLOR_BYTES + ORIENTATION_BYTES + ENABLED_BYTES;
+
+inline unsigned color(const std::uint8_t *chunk, unsigned slot)
+{
+    return chunk[slot / 4] >> (slot % 4 * 2) & 3;
+}
+
+inline unsigned orientation(const std::uint8_t *chunk, unsigned slot)
+{
+    return chunk[COLOR_BYTES + slot / 4] >> (slot % 4 * 2) & 3;
+}
+
+inline bool enabled(const std::uint8_t *chunk, unsigned slot)
+{
+    return chunk[COLOR_BYTES + ORIENTATION_BYTES + slot / 8] >> (slot % 8) & 1;
+}
+
+// the bytes of a chunk have to be zeroed first
+inline void set(std::uint8_t *chunk, unsigned slot, unsigned color, unsigned orientation, bool enabled)
+{
+    chunk[slot / 4] |= std::uint8_t((color & 3) << (slot % 4 * 2));
+    chunk[COLOR_BYTES + slot / 4] |= std::uint8_t((orientation & 3) << (slot % 4 * 2));
+    chunk[COLOR_BYTES + ORIENTATION_BYTES + slot / 8] |= std::uint8_t(enabled << (slot % 8));
+}
+
+template <typename F>
+void forEachEnabled(const std::uint8_t *chunk, F f)
+{
+    const auto *bits = chunk + COLOR_BYTES + ORIENTATION_BYTES;
+    for (unsigned i = 0; i < ENABLED_BYTES; ++i)
+        for (unsigned byte = bits[i]; byte != 0; byte &= byte - 1)
+            f(i * 8 + lowestBitIndex(byte));
+}
+
+} // namespace ChunkBits
+
+using ChunkData = std::array<std::uint8_t, ChunkBits::SIZE>;
+
+#endif /* SRC_TILECHUNK_H_ */
@@ -0,0 +1,69 @@
+/*
+ * TileCoord.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_TILECOORD_H_
+#define SRC_TILECOORD_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+// Position of a tile in the grid laid out by TileParams:
+// even and odd rows are shifted by half a column,
+// so each tile touches two tiles above and below it in the rows +-1,
+// and one tile in each of the rows +-2.
+struct TileCoord
+{
+    int row;
+    int col;
+
+    bool operator ==(const TileCoord &other) const
+    {
+        return row == other.row && col == other.col;
+    }
+
+    bool operator !=(const TileCoord &other) const
+    {
+        return !(*this == other);
+    }
+
+    std::array<TileCoord, 6> neighbours() const
+    {
+        const int left = col - 1 + (row & 1);
+        const int right = col + (row & 1);
+        return {{
+            TileCoord { row - 2, col },
+            TileCoord { row - 1, right },
+            TileCoord { row + 1, right },
+            TileCoord { row + 2, col },
+            TileCoord { row + 1, left },
+            TileCoord { row - 1, left },
+        }};
+    }
+};
+
+namespace std {
+
+template<>
+struct hash<TileCoord>
+{
+    size_t operator()(const TileCoord &coord) const
+    {
+        const auto key = (std::uint64_t) (std::uint32_t) coord.row << 32 | (std::uint32_t) coord.col;
+        // 64 bit finalizer of MurmurHash3, so that neighbouring tiles do not collide
+        auto h = key ^ (key >> 33);
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return (size_t) h;
+    }
+};
+
+} // namespace std
+
+#endif /* SRC_TILECOORD_H_ */
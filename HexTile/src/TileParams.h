@@ -10,6 +10,12 @@
 
 #include "AppConsts.h"
 #include "FloatConsts.h"
+#include "TileCoord.h"
+
+#include <ofRectangle.h>
+#include <ofVec2f.h>
+
+#include <cmath>
 
 
 namespace TileParams {
@@ -33,6 +39,79 @@ inline ofVec2f center(int row, int col)
                    row_height * row + row_offset);
 }
 
+inline ofVec2f center(const TileCoord &coord)
+{
+    return center(coord.row, coord.col);
+}
+
+// The hexagon shared by all tiles, centered on the origin.
+// Vertex i is at the angle i * 60 degrees.
+static constexpr float vertex_x[6] = { radius, radius * cos_60_deg, -radius * cos_60_deg,
+                                       -radius, -radius * cos_60_deg, radius * cos_60_deg };
+static constexpr float vertex_y[6] = { 0, row_height, row_height,
+                                       0, -row_height, -row_height };
+
+inline ofVec2f vertex(const ofVec2f &center, int i)
+{
+    return ofVec2f(center.x + vertex_x[i], center.y + vertex_y[i]);
+}
+
+inline ofVec2f vertex(const TileCoord &coord, int i)
+{
+    return vertex(center(coord), i);
+}
+
+inline ofRectangle box(const TileCoord &coord)
+{
+    const auto c = center(coord);
+    return ofRectangle(c.x - radius, c.y - row_height, 2 * radius, 2 * row_height);
+}
+
+// the box with the shadow and the outline, which reach out of the tile
+inline ofRectangle drawn_box(const TileCoord &coord)
+{
+    auto rect = box(coord);
+    rect.x -= LINE_WIDTH_PIX;
+    rect.y -= LINE_WIDTH_PIX;
+    rect.width += 2 * LINE_WIDTH_PIX;
+    rect.height += 2 * LINE_WIDTH_PIX;
+    return rect;
+}
+
+// Grid position of the tile containing the point (x, y).
+// The rows and columns are those of the axial coordinates (q, r)
+// of the flat-topped hexagon grid, where q = 2 * col + (row & 1) and row = 2 * r + q,
+// so the point is rounded to the nearest hexagon in cube coordinates.
+inline TileCoord coord_at(float x, float y)
+{
+    const float q = (x - col_offset[0]) / (col_width / 2);
+    const float r = ((y - row_offset) / row_height - q) / 2;
+    const float s = -q - r;
+
+    float rq = std::round(q);
+    float rr = std::round(r);
+    const float rs = std::round(s);
+
+    const float dq = std::abs(rq - q);
+    const float dr = std::abs(rr - r);
+    const float ds = std::abs(rs - s);
+
+    if (dq > dr && dq > ds)
+        rq = -rr - rs;
+    else if (dr > ds)
+        rr = -rq - rs;
+
+    const int axial_q = (int) rq;
+    const int axial_r = (int) rr;
+
+    return TileCoord { 2 * axial_r + axial_q, (axial_q - (axial_q & 1)) / 2 };
+}
+
+inline bool inside(const TileCoord &coord, float x, float y)
+{
+    return coord_at(x, y) == coord;
+}
+
 struct IntRange
 {
     int begin;
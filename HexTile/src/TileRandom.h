@@ -0,0 +1,51 @@
+/*
+ * TileRandom.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_TILERANDOM_H_
+#define SRC_TILERANDOM_H_
+
+#include "TileCoord.h"
+
+#include <cstdint>
+
+// Counter-based random numbers: a pure function of the key, the tile and a counter.
+// There is no state to share, so tiles can be randomized on any thread, in any
+// order, or only when they are first needed, and a key always gives the same floor.
+class TileRandom
+{
+public:
+    // the numbers of the command number stream of a floor randomized with seed
+    TileRandom(std::uint64_t seed, std::uint64_t stream) :
+        key(mix(seed ^ mix(stream + 0x9e3779b97f4a7c15ULL)))
+    {
+    }
+
+    std::uint64_t bits(const TileCoord &coord, unsigned counter = 0) const
+    {
+        const auto tile = (std::uint64_t) (std::uint32_t) coord.row << 32 | (std::uint32_t) coord.col;
+        return mix(mix(key ^ tile) + counter);
+    }
+
+    // in [0, 1)
+    float uniform(const TileCoord &coord, unsigned counter = 0) const
+    {
+        return (bits(coord, counter) >> 40) * (1.f / (1 << 24));
+    }
+
+private:
+    // finalizer of SplitMix64, every bit of the input affects every bit of the output
+    static std::uint64_t mix(std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::uint64_t key;
+};
+
+#endif /* SRC_TILERANDOM_H_ */
@@ -0,0 +1,191 @@
+/*
+ * TileStore.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "TileStore.h"
+
+#include <ciso646>
+
+#include <algorithm>
+
+TileId TileStore::insert(const TileCoord &coord)
+{
+    const auto found = index.find(coord);
+    if (found != index.end())
+        return found->second;
+
+    TileId id;
+    if (not freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        coords[id] = coord;
+    } else {
+        id = (TileId) coords.size();
+        const size_t size = id + 1;
+        coords.push_back(coord);
+
+        for (auto *bits : { &live, &enabled, &transition, &viewable })
+            bits->resize(size);
+        colors.resize(size);
+        orientations.resize(size);
+
+        alphas.resize(size, 0);
+        fadeSlot.resize(size, 0);
+    }
+    index.emplace(coord, id);
+
+    live.set(id, true);
+    enabled.set(id, false);
+    transition.set(id, false);
+    viewable.set(id, false);
+    colors.set(id, (unsigned) TileColor::White);
+    orientations.set(id, (unsigned) Orientation::Blank);
+
+    alphas[id] = 0;
+
+    touch(id);
+    return id;
+}
+
+void TileStore::erase(TileId id)
+{
+    index.erase(coords[id]);
+    if (transition.get(id)) {
+        transition.set(id, false);
+        endFade(fadeSlot[id]);
+    }
+    live.set(id, false);
+    freeIds.push_back(id);
+    touch(id);
+}
+
+void TileStore::clear()
+{
+    index.clear();
+    freeIds.clear();
+    coords.clear();
+    for (auto *bits : { &live, &enabled, &transition, &viewable })
+        bits->resize(0);
+    colors.resize(0);
+    orientations.resize(0);
+    alphas.clear();
+    fadeSlot.clear();
+    fadeIds.clear();
+    for (auto *values : { &fadeFrom, &fadeTo, &fadeBegin, &fadeRate })
+        values->clear();
+
+    editLog.clear();
+    editLogBase = ++edits;
+}
+
+void TileStore::assign(TileId id, TileColor color, Orientation orientation, bool enable)
+{
+    if (transition.get(id)) {
+        transition.set(id, false);
+        endFade(fadeSlot[id]);
+    }
+    colors.set(id, (unsigned) color);
+    orientations.set(id, (unsigned) orientation);
+    enabled.set(id, enable);
+    alphas[id] = enable ? 1 : 0;
+    touch(id);
+}
+
+void TileStore::setEnabled(TileId id, bool enable)
+{
+    if (enabled.get(id) == enable)
+        return;
+    enabled.set(id, enable);
+    if (transition.get(id))
+        fadeTo[fadeSlot[id]] = enable ? 1 : 0;
+    touch(id);
+}
+
+void TileStore::startFade(TileId id, bool enable, const TimeStamp &now, Duration duration)
+{
+    if (fadeIds.empty())
+        epoch = now;
+
+    if (not transition.get(id)) {
+        transition.set(id, true);
+        fadeSlot[id] = (std::uint32_t) fadeIds.size();
+        fadeIds.push_back(id);
+        for (auto *values : { &fadeFrom, &fadeTo, &fadeBegin, &fadeRate })
+            values->push_back(0);
+    }
+    enabled.set(id, enable);
+
+    const auto slot = fadeSlot[id];
+    fadeFrom[slot] = alphas[id];
+    fadeTo[slot] = enable ? 1 : 0;
+    fadeBegin[slot] = seconds(now);
+    fadeRate[slot] = 1 / duration_cast<FloatSeconds>(duration).count();
+    touch(id);
+}
+
+void TileStore::reserveFades(size_t count)
+{
+    fadeIds.reserve(count);
+    for (auto *values : { &fadeFrom, &fadeTo, &fadeBegin, &fadeRate })
+        values->reserve(count);
+}
+
+void TileStore::endFade(size_t slot)
+{
+    const auto last = fadeIds.size() - 1;
+    if (slot != last) {
+        fadeIds[slot] = fadeIds[last];
+        fadeFrom[slot] = fadeFrom[last];
+        fadeTo[slot] = fadeTo[last];
+        fadeBegin[slot] = fadeBegin[last];
+        fadeRate[slot] = fadeRate[last];
+        fadeSlot[fadeIds[slot]] = (std::uint32_t) slot;
+    }
+    fadeIds.pop_back();
+    for (auto *values : { &fadeFrom, &fadeTo, &fadeBegin, &fadeRate })
+        values->pop_back();
+}
+
+bool TileStore::update_alpha(const TimeStamp &now)
+{
+    if (fadeIds.empty())
+        return false;
+
+    const float t = seconds(now);
+    const size_t count = fadeIds.size();
+    fadeAlphas.resize(count);
+    fadeDone.resize(count);
+
+    // no branches, so that the compiler can vectorize it
+    const float *from = fadeFrom.data();
+    const float *to = fadeTo.data();
+    const float *begin = fadeBegin.data();
+    const float *rate = fadeRate.data();
+    float *alpha = fadeAlphas.data();
+    std::uint8_t *done = fadeDone.data();
+    for (size_t slot = 0; slot < count; ++slot) {
+        const float progress = std::min(std::max((t - begin[slot]) * rate[slot], 0.f), 1.f);
+        alpha[slot] = from[slot] + (to[slot] - from[slot]) * progress;
+        done[slot] = progress >= 1;
+    }
+
+    for (size_t slot = 0; slot < count; ++slot)
+        alphas[fadeIds[slot]] = alpha[slot];
+
+    // backwards, so that a finished fade is replaced by one that is not
+    for (size_t slot = count; slot-- > 0;) {
+        if (not done[slot])
+            continue;
+        const auto id = fadeIds[slot];
+        transition.set(id, false);
+        endFade(slot);
+        // a tile that faded out is no longer visible
+        if (not enabled.get(id))
+            touch(id);
+    }
+
+    return true;
+}
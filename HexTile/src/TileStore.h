@@ -0,0 +1,404 @@
+/*
+ * TileStore.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_TILESTORE_H_
+#define SRC_TILESTORE_H_
+
+#include "Clock.h"
+#include "PackedBits.h"
+#include "TileCoord.h"
+#include "WorkerPool.h"
+
+#include <ciso646>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+enum class TileColor
+{
+    Black,
+    Gray,
+    White,
+};
+
+enum class Orientation
+{
+    Blank = 0,
+    Odd = 1,
+    Even = 2,
+};
+
+using TileId = std::uint32_t;
+static constexpr TileId NO_TILE = ~TileId(0);
+
+// Tile state in structure-of-arrays layout, indexed by TileId.
+// Ids of erased tiles are reused, so the arrays stay dense.
+// The geometry is not stored, it follows from the coordinates (see TileParams).
+// Color, orientation and the flags are bit-packed.
+// Running fades are kept in an active list of float arrays packed by slot,
+// evaluated in a branch-free pass over the list.
+// TileView keeps only the tiles of the chunks around the view here,
+// so forEach and bulkEdit do not cover the whole floor.
+class TileStore
+{
+public:
+    TileId find(const TileCoord &coord) const
+    {
+        const auto found = index.find(coord);
+        return found != index.end() ? found->second : NO_TILE;
+    }
+
+    // returns the existing tile at coord or creates a new one
+    TileId insert(const TileCoord &coord);
+    void erase(TileId id);
+    // erases every tile; the edit count goes on counting
+    void clear();
+
+    size_t size() const
+    {
+        return index.size();
+    }
+
+    // upper bound of the ids in use
+    TileId capacity() const
+    {
+        return (TileId) coords.size();
+    }
+
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (size_t w = 0; w < live.wordCount(); ++w)
+            for (auto bits = live.word(w); bits != 0; bits &= bits - 1)
+                f(TileId(w * 64 + lowestBitIndex(bits)));
+    }
+
+    const TileCoord &coord(TileId id) const
+    {
+        return coords[id];
+    }
+
+    TileColor color(TileId id) const
+    {
+        return (TileColor) colors.get(id);
+    }
+
+    void setColor(TileId id, TileColor color)
+    {
+        if (colors.get(id) == (unsigned) color)
+            return;
+        colors.set(id, (unsigned) color);
+        touch(id);
+    }
+
+    Orientation orientation(TileId id) const
+    {
+        return (Orientation) orientations.get(id);
+    }
+
+    void setOrientation(TileId id, Orientation orientation)
+    {
+        if (orientations.get(id) == (unsigned) orientation)
+            return;
+        orientations.set(id, (unsigned) orientation);
+        touch(id);
+    }
+
+    bool isEnabled(TileId id) const
+    {
+        return enabled.get(id);
+    }
+
+    // changes the target of a running fade, but does not start one
+    void setEnabled(TileId id, bool enable);
+
+    // sets the whole state of a tile at once, ending its fade
+    void assign(TileId id, TileColor color, Orientation orientation, bool enable);
+
+    bool isInTransition(TileId id) const
+    {
+        return transition.get(id);
+    }
+
+    // equal for the tiles that a flood fill treats as the same
+    unsigned floodState(TileId id) const
+    {
+        if (not enabled.get(id) and not transition.get(id))
+            return 0;
+        return 1 | colors.get(id) << 1 | orientations.get(id) << 3;
+    }
+
+    bool isViewable(TileId id) const
+    {
+        return viewable.get(id);
+    }
+
+    void setViewable(TileId id, bool value)
+    {
+        viewable.set(id, value);
+    }
+
+    float alpha(TileId id) const
+    {
+        return alphas[id];
+    }
+
+    void startFade(TileId id, bool enable, const TimeStamp &now, Duration duration);
+
+    // advances all running fades, returns false if there were none.
+    // Only the fading tiles are visited.
+    bool update_alpha(const TimeStamp &now);
+
+    size_t transitionCount() const
+    {
+        return fadeIds.size();
+    }
+
+    // nothing fades, so nothing changes until the next edit
+    bool isIdle() const
+    {
+        return fadeIds.empty();
+    }
+
+    template <typename F>
+    void forEachInTransition(F f) const
+    {
+        for (auto id : fadeIds)
+            f(id);
+    }
+
+    // A copy of the state of a tile, changed by a bulk edit and written back.
+    // Fades are only requested, they start when the edit is merged.
+    struct BulkTile
+    {
+        TileColor color;
+        Orientation orientation;
+        bool enabled;
+        bool inTransition;
+        enum class Fade : std::uint8_t { None, In, Out } fade = Fade::None;
+
+        bool isVisible() const
+        {
+            return enabled || inTransition;
+        }
+
+        void start_enabling()
+        {
+            if (!enabled)
+                fade = Fade::In;
+        }
+        void start_disabling()
+        {
+            if (enabled)
+                fade = Fade::Out;
+        }
+
+        // the same as the methods of Tile
+        void changeColorUp()
+        {
+            if (!enabled) {
+                if (!inTransition) {
+                    color = TileColor::White;
+                    orientation = Orientation::Blank;
+                }
+                start_enabling();
+                return;
+            }
+            color = (TileColor) (((int) color + 1) % 3);
+        }
+        void changeColorDown()
+        {
+            if (!enabled) {
+                if (!inTransition) {
+                    color = TileColor::Black;
+                    orientation = Orientation::Blank;
+                }
+                start_enabling();
+                return;
+            }
+            color = (TileColor) (((int) color + 2) % 3);
+        }
+        void changeOrientationUp()
+        {
+            orientation = orientation == Orientation::Blank ? Orientation::Even : (Orientation) (3 - (int) orientation);
+        }
+        void changeOrientationDown()
+        {
+            orientation = orientation == Orientation::Blank ? Orientation::Odd : (Orientation) (3 - (int) orientation);
+        }
+    };
+
+    // Calls edit(BulkTile &) for every tile that satisfies predicate(const BulkTile &),
+    // slices of the tiles on all threads of the pool at once, so both must only
+    // look at their argument. The slices are split at word boundaries of the
+    // packed arrays, so no two threads write the same word.
+    // The changed tiles are then logged and their fades started in one pass.
+    template <typename P, typename E>
+    void bulkEdit(WorkerPool &pool, const TimeStamp &now, Duration fadeIn, Duration fadeOut, P predicate, E edit);
+
+    // Counts the changes to the tiles: insertion, erasure, and anything
+    // that changes floodState() or what the tile looks like.
+    std::uint64_t editCount() const
+    {
+        return edits;
+    }
+
+    // Calls f(id) for the tiles changed since editCount() returned since.
+    // Returns false if the log no longer reaches back that far,
+    // in which case the caller has to assume that everything changed.
+    template <typename F>
+    bool forEachEditSince(std::uint64_t since, F f) const
+    {
+        if (since < editLogBase)
+            return false;
+        for (size_t i = since - editLogBase; i < editLog.size(); ++i)
+            f(editLog[i]);
+        return true;
+    }
+
+private:
+    static constexpr size_t EDIT_LOG_LIMIT = 1 << 16;
+    // words of live per slice of a bulk edit, 64 tiles each
+    static constexpr size_t BULK_SLICE_WORDS = 64;
+
+    struct BulkSlice
+    {
+        std::vector<TileId> changed;
+        std::vector<TileId> fadeIn;
+        std::vector<TileId> fadeOut;
+    };
+
+    void endFade(size_t slot);
+
+    void touch(TileId id)
+    {
+        if (editLog.size() == EDIT_LOG_LIMIT) {
+            editLog.clear();
+            editLogBase = edits;
+        }
+        editLog.push_back(id);
+        ++edits;
+    }
+
+    // logs many edits at once, or forgets the log if they do not fit
+    void touch(const std::vector<TileId> &ids)
+    {
+        if (editLog.size() + ids.size() > EDIT_LOG_LIMIT) {
+            edits += ids.size();
+            editLog.clear();
+            editLogBase = edits;
+            return;
+        }
+        editLog.insert(editLog.end(), ids.begin(), ids.end());
+        edits += ids.size();
+    }
+
+    void reserveFades(size_t count);
+
+    float seconds(const TimeStamp &now) const
+    {
+        return duration_cast<FloatSeconds>(now - epoch).count();
+    }
+
+    std::unordered_map<TileCoord, TileId> index;
+    std::vector<TileId> freeIds;
+
+    // cold data
+    std::vector<TileCoord> coords;
+
+    // hot data
+    PackedBits<1> live;
+    PackedBits<1> enabled;
+    PackedBits<1> transition;
+    PackedBits<1> viewable;
+    PackedBits<2> colors;
+    PackedBits<2> orientations;
+
+    std::vector<float> alphas;
+
+    // Running fades, packed by slot; fadeSlot[id] is the slot of a tile in transition.
+    // A finished fade is replaced by the last one.
+    // alpha = from + (to - from) * clamp((t - begin) * rate, 0, 1);
+    std::vector<std::uint32_t> fadeSlot;
+    std::vector<TileId> fadeIds;
+    std::vector<float> fadeFrom;
+    std::vector<float> fadeTo;
+    std::vector<float> fadeBegin;
+    std::vector<float> fadeRate;
+    // the alphas of the slots and whether they finished, from the last update_alpha
+    std::vector<float> fadeAlphas;
+    std::vector<std::uint8_t> fadeDone;
+
+    // fade times are seconds since epoch, which is moved forward
+    // whenever nothing fades, so that float precision does not run out
+    TimeStamp epoch;
+
+    std::uint64_t edits = 0;
+    std::uint64_t editLogBase = 0;
+    std::vector<TileId> editLog;
+
+    std::vector<BulkSlice> bulkSlices;
+};
+
+template <typename P, typename E>
+void TileStore::bulkEdit(WorkerPool &pool, const TimeStamp &now, Duration fadeIn, Duration fadeOut, P predicate, E edit)
+{
+    const size_t words = live.wordCount();
+    const size_t count = (words + BULK_SLICE_WORDS - 1) / BULK_SLICE_WORDS;
+    if (bulkSlices.size() < count)
+        bulkSlices.resize(count);
+
+    pool.parallel_for(words, BULK_SLICE_WORDS, [&](size_t begin, size_t end) {
+        auto &slice = bulkSlices[begin / BULK_SLICE_WORDS];
+        slice.changed.clear();
+        slice.fadeIn.clear();
+        slice.fadeOut.clear();
+
+        for (size_t w = begin; w < end; ++w) {
+            for (auto bits = live.word(w); bits != 0; bits &= bits - 1) {
+                const auto id = TileId(w * 64 + lowestBitIndex(bits));
+                BulkTile tile {
+                    (TileColor) colors.get(id),
+                    (Orientation) orientations.get(id),
+                    enabled.get(id) != 0,
+                    transition.get(id) != 0,
+                };
+                if (not predicate(static_cast<const BulkTile &>(tile)))
+                    continue;
+                const auto color = tile.color;
+                const auto orientation = tile.orientation;
+                edit(tile);
+
+                if (tile.color != color or tile.orientation != orientation) {
+                    colors.set(id, (unsigned) tile.color);
+                    orientations.set(id, (unsigned) tile.orientation);
+                    slice.changed.push_back(id);
+                }
+                if (tile.fade == BulkTile::Fade::In)
+                    slice.fadeIn.push_back(id);
+                else if (tile.fade == BulkTile::Fade::Out)
+                    slice.fadeOut.push_back(id);
+            }
+        }
+    });
+
+    size_t fades = 0;
+    for (size_t i = 0; i < count; ++i)
+        fades += bulkSlices[i].fadeIn.size() + bulkSlices[i].fadeOut.size();
+    reserveFades(fadeIds.size() + fades);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto &slice = bulkSlices[i];
+        touch(slice.changed);
+        for (auto id : slice.fadeIn)
+            startFade(id, true, now, fadeIn);
+        for (auto id : slice.fadeOut)
+            startFade(id, false, now, fadeOut);
+    }
+}
+
+#endif /* SRC_TILESTORE_H_ */
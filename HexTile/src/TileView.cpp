@@ -8,63 +8,618 @@
 #include "TileView.h"
 #include "TileParams.h"
 
-#include <set>
-#include <deque>
 #include <ciso646>
 
 #include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <utility>
 
 #include <iterator>
 
+// predicates of the whole floor edits
+static const auto isVisible = [](const TileStore::BulkTile &tile) { return tile.isVisible(); };
+static const auto isOriented = [](const TileStore::BulkTile &tile) {
+    return tile.isVisible() and tile.orientation != Orientation::Blank;
+};
+
+// either may be nullptr for a chunk without tiles
+static bool isSameChunk(const std::uint8_t *a, const std::uint8_t *b)
+{
+    if (a == nullptr)
+        std::swap(a, b);
+    if (a == nullptr)
+        return true;
+    if (b != nullptr)
+        return std::equal(a, a + ChunkBits::SIZE, b);
+    return std::all_of(a, a + ChunkBits::SIZE, [](std::uint8_t byte) { return byte == 0; });
+}
+
 void TileView::createTiles()
 {
-    auto range = TileParams::tile_range(viewSize, view.zoom, view.offset);
+    createMissingTiles(view);
+}
+
+TileId TileView::addViewableTile(const TileCoord &coord)
+{
+    const auto id = tiles.insert(coord);
+    if (not tiles.isViewable(id)) {
+        tiles.setViewable(id, true);
+        viewableTiles.push_back(id);
+        ++viewableChanges;
+    }
+    return id;
+}
+
+TileId TileView::editableTile(const TileCoord &coord)
+{
+    materializeChunks(TileParams::TileRange { { coord.row, coord.row }, { coord.col, coord.col } });
+    return tiles.insert(coord);
+}
+
+void TileView::createMissingTiles(const ViewCoords &view)
+{
+    const auto range = TileParams::tile_range(viewSize, view.zoom, view.offset);
+
+    materializeChunks(range);
 
     for (int row = range.rows.begin; row <= range.rows.end; ++row) {
         for (int col = range.cols.begin; col <= range.cols.end; col++) {
-            auto center = TileParams::center(row, col);
-            tiles.emplace_back(center.x, center.y, TileParams::radius);
+            addViewableTile(TileCoord { row, col });
+        }
+    }
+}
+
+void TileView::queueMissingTiles(const ViewCoords &view)
+{
+    const auto range = TileParams::tile_range(viewSize, view.zoom, view.offset);
+    const auto rect = view.getViewRect(viewSize);
+    const ofVec2f center(rect.x + rect.width / 2, rect.y + rect.height / 2);
+
+    pendingBlocks.clear();
+    for (int row = range.rows.begin; row <= range.rows.end; row += PENDING_BLOCK_ROWS) {
+        for (int col = range.cols.begin; col <= range.cols.end; col += PENDING_BLOCK_COLS) {
+            pendingBlocks.push_back(TileParams::TileRange {
+                { row, std::min(row + PENDING_BLOCK_ROWS - 1, range.rows.end) },
+                { col, std::min(col + PENDING_BLOCK_COLS - 1, range.cols.end) }
+            });
         }
     }
 
-    viewableTiles.reserve(tiles.size());
+    const auto distance = [&center](const TileParams::TileRange &block) {
+        const auto area = blockArea(block);
+        return ofVec2f(area.x + area.width / 2, area.y + area.height / 2).squareDistance(center);
+    };
+    std::sort(pendingBlocks.begin(), pendingBlocks.end(),
+              [&distance](const TileParams::TileRange &a, const TileParams::TileRange &b) {
+        return distance(a) > distance(b);
+    });
+}
 
-    for (auto tile = tiles.begin(); tile != tiles.end(); ++tile) {
-        for (auto other_tile = tiles.begin(); other_tile != tile; ++other_tile)
-            tile->connectIfNeighbour(&*other_tile);
-        viewableTiles.push_back(&*tile);
+bool TileView::createPendingTiles(const Duration &budget)
+{
+    const auto start = Clock::now();
+
+    ChunkCoord chunk;
+    ChunkData data;
+    while (prefetch.take(chunk, data))
+        if (residentChunks.count(chunk) == 0 and not (building.active and building.chunk == chunk))
+            prefetched[chunk] = data;
+
+    const bool created = not pendingBlocks.empty();
+    while (not pendingBlocks.empty()) {
+        const auto block = pendingBlocks.back();
+        pendingBlocks.pop_back();
+
+        materializeChunks(block);
+        for (int row = block.rows.begin; row <= block.rows.end; ++row)
+            for (int col = block.cols.begin; col <= block.cols.end; ++col)
+                addViewableTile(TileCoord { row, col });
+        if (Clock::now() - start >= budget)
+            break;
     }
+
+    // the time left goes to the chunks the view is heading for
+    while (Clock::now() - start < budget) {
+        if (not building.active) {
+            if (prefetched.empty())
+                break;
+            const auto next = prefetched.begin();
+            building.chunk = next->first;
+            const auto found = chunkCache.take(building.chunk, building.data);
+            if (found == ChunkCache::Found::Unreadable)
+                chunkLost(building.chunk);
+            if (found != ChunkCache::Found::Chunk) {
+                building.data = next->second;
+                baseEdit.apply(building.data);
+            }
+            building.nextByte = 0;
+            building.active = true;
+            prefetched.erase(next);
+        }
+        buildChunk(start, budget);
+    }
+    return created;
 }
 
-void TileView::createMissingTiles(const ViewCoords &view)
+bool TileView::buildChunk(const TimeStamp &start, const Duration &budget)
 {
-    const auto findTile = [this](const ofVec2f &center) {
-        const auto found = std::find_if(tiles.begin(), tiles.end(), [&center](const Tile &tile) {
-            return tile.squareDistanceFromCenter(center) < tile.radiusSquared();
-        });
-        return found != tiles.end() ? &*found : nullptr;
+    // the clock is read every few bytes, up to 8 tiles each
+    static constexpr unsigned BYTES_PER_CHECK = 16;
+
+    const auto *bits = building.data.data();
+    const auto *enabled = bits + ChunkBits::COLOR_BYTES + ChunkBits::ORIENTATION_BYTES;
+    while (building.nextByte < ChunkBits::ENABLED_BYTES) {
+        const unsigned i = building.nextByte++;
+        for (unsigned byte = enabled[i]; byte != 0; byte &= byte - 1)
+            insertChunkTile(building.chunk, bits, i * 8 + lowestBitIndex(byte));
+        if (building.nextByte % BYTES_PER_CHECK == 0 and Clock::now() - start >= budget)
+            return false;
+    }
+    residentChunks.insert(building.chunk);
+    building.active = false;
+    return true;
+}
+
+void TileView::finishBuilding()
+{
+    if (building.active)
+        buildChunk(Clock::now(), Duration::max());
+}
+
+void TileView::insertChunkTile(const ChunkCoord &chunk, const std::uint8_t *bits, unsigned slot)
+{
+    const auto id = tiles.insert(chunk.tile(slot));
+    tiles.assign(id,
+                 (TileColor) ChunkBits::color(bits, slot),
+                 (Orientation) ChunkBits::orientation(bits, slot),
+                 true);
+}
+
+void TileView::prefetchAhead(const TimeStamp &now)
+{
+    const auto rect = nextView.getViewRect(viewSize);
+    const ofVec2f target(rect.x + rect.width / 2, rect.y + rect.height / 2);
+    const float elapsed = FloatSeconds(now - lastTargetTime).count();
+    if (elapsed > 0 and elapsed < MAX_MOVE_INTERVAL_SECONDS)
+        velocity = (velocity + (target - lastTarget) / elapsed) / 2;
+    else
+        velocity = ofVec2f(0, 0);
+    lastTarget = target;
+    lastTargetTime = now;
+
+    // a ring of blocks all around, and up to a chunk in the direction of the move
+    auto range = TileParams::tile_range(viewSize, nextView.zoom, nextView.offset);
+    const auto ahead = velocity * PREFETCH_AHEAD_SECONDS;
+    const int ringCols = PENDING_BLOCK_COLS;
+    const int ringRows = PENDING_BLOCK_ROWS;
+    const int cols = std::min(CHUNK_COLS, ringCols + (int) std::ceil(std::abs(ahead.x) / TileParams::col_width));
+    const int rows = std::min(CHUNK_ROWS, ringRows + (int) std::ceil(std::abs(ahead.y) / TileParams::row_height));
+    range.cols.begin -= ahead.x < 0 ? cols : ringCols;
+    range.cols.end += ahead.x > 0 ? cols : ringCols;
+    range.rows.begin -= ahead.y < 0 ? rows : ringRows;
+    range.rows.end += ahead.y > 0 ? rows : ringRows;
+
+    const auto first = ChunkCoord::of(TileCoord { range.rows.begin, range.cols.begin });
+    const auto last = ChunkCoord::of(TileCoord { range.rows.end, range.cols.end });
+    std::vector<ChunkCoord> chunks;
+    for (int row = first.row; row <= last.row; ++row) {
+        for (int col = first.col; col <= last.col; ++col) {
+            const ChunkCoord chunk { row, col };
+            if (residentChunks.count(chunk) == 0 and prefetched.count(chunk) == 0
+                    and not (building.active and building.chunk == chunk))
+                chunks.push_back(chunk);
+        }
+    }
+
+    // the nearest is read first
+    const auto distance = [&target](const ChunkCoord &chunk) {
+        return TileParams::center(chunk.tile(CHUNK_TILES / 2 + CHUNK_COLS / 2)).squareDistance(target);
     };
+    std::sort(chunks.begin(), chunks.end(), [&distance](const ChunkCoord &a, const ChunkCoord &b) {
+        return distance(a) > distance(b);
+    });
+    prefetch.request(floor, pattern, std::move(chunks));
+}
 
-    const auto range = TileParams::tile_range(viewSize, view.zoom, view.offset);
+void TileView::stopPrefetch()
+{
+    prefetch.cancel();
+    prefetched.clear();
+}
 
-    for (int row = range.rows.begin; row <= range.rows.end; ++row) {
-        for (int col = range.cols.begin; col <= range.cols.end; col++) {
-            auto center = TileParams::center(row, col);
-            auto existingTile = findTile(center);
-            if (existingTile != nullptr) {
-                if (std::find(viewableTiles.begin(), viewableTiles.end(), existingTile) == viewableTiles.end())
-                    viewableTiles.push_back(existingTile);
+// the blocks of a view tile it without overlapping
+ofRectangle TileView::blockArea(const TileParams::TileRange &block)
+{
+    using namespace TileParams;
+    const float left = col_width * block.cols.begin + col_offset[0] - radius;
+    const float top = row_height * block.rows.begin;
+    return ofRectangle(left, top,
+                       col_width * (block.cols.end + 1 - block.cols.begin),
+                       row_height * (block.rows.end + 1 - block.rows.begin));
+}
+
+void TileView::materializeChunks(const TileParams::TileRange &range)
+{
+    const auto first = ChunkCoord::of(TileCoord { range.rows.begin, range.cols.begin });
+    const auto last = ChunkCoord::of(TileCoord { range.rows.end, range.cols.end });
+
+    ChunkData cached;
+    for (int row = first.row; row <= last.row; ++row) {
+        for (int col = first.col; col <= last.col; ++col) {
+            const ChunkCoord chunk { row, col };
+            if (building.active and building.chunk == chunk) {
+                finishBuilding();
                 continue;
             }
-            tiles.emplace_back(center.x, center.y, TileParams::radius);
-            const auto last = std::prev(tiles.end());
-            viewableTiles.push_back(&*last);
-            for (auto tile = tiles.begin(); tile != last; ++tile)
-                tile->connectIfNeighbour(&*last);
+            if (not residentChunks.insert(chunk).second)
+                continue;
+            const auto ahead = prefetched.find(chunk);
+            const auto found = chunkCache.take(chunk, cached);
+            if (found == ChunkCache::Found::Unreadable)
+                chunkLost(chunk);
+            const std::uint8_t *bits;
+            if (found == ChunkCache::Found::Chunk)
+                bits = cached.data();
+            else if (ahead != prefetched.end() and baseEdit.isNone())
+                bits = ahead->second.data();
+            else if (ahead != prefetched.end()) {
+                cached = ahead->second;
+                baseEdit.apply(cached);
+                bits = cached.data();
+            } else
+                bits = baseChunk(chunk, cached);
+            if (bits != nullptr)
+                ChunkBits::forEachEnabled(bits, [&](unsigned slot) { insertChunkTile(chunk, bits, slot); });
+            if (ahead != prefetched.end())
+                prefetched.erase(ahead);
         }
     }
 }
 
+// evicted holds the packed tiles of the chunks outside the range
+void TileView::evictChunks(std::unordered_map<ChunkCoord, ChunkData> &evicted, const TileParams::TileRange &range)
+{
+    const auto first = ChunkCoord::of(TileCoord { range.rows.begin, range.cols.begin });
+    const auto last = ChunkCoord::of(TileCoord { range.rows.end, range.cols.end });
+
+    for (auto chunk = residentChunks.begin(); chunk != residentChunks.end();) {
+        if (chunk->row < first.row or chunk->row > last.row or chunk->col < first.col or chunk->col > last.col) {
+            // value initialized: a chunk without tiles is all zeros
+            evicted[*chunk];
+            chunk = residentChunks.erase(chunk);
+        } else {
+            ++chunk;
+        }
+    }
+
+    for (auto chunk = prefetched.begin(); chunk != prefetched.end();) {
+        if (chunk->first.row < first.row or chunk->first.row > last.row
+                or chunk->first.col < first.col or chunk->first.col > last.col)
+            chunk = prefetched.erase(chunk);
+        else
+            ++chunk;
+    }
+
+    for (const auto &chunk : evicted)
+        packChunk(chunk.first, chunk.second);
+}
+
+void TileView::evictChunk(const ChunkCoord &chunk)
+{
+    // value initialized: a chunk without tiles is all zeros
+    ChunkData data {};
+    for (unsigned slot = 0; slot < CHUNK_TILES; ++slot) {
+        const auto id = tiles.find(chunk.tile(slot));
+        if (id == NO_TILE)
+            continue;
+        if (tiles.isEnabled(id))
+            ChunkBits::set(data.data(), slot, (unsigned) tiles.color(id), (unsigned) tiles.orientation(id), true);
+        eraseTile(id);
+    }
+    residentChunks.erase(chunk);
+    packChunk(chunk, data);
+}
+
+// the id is handed out again for another tile, so nothing may keep it
+void TileView::eraseTile(TileId id)
+{
+    if (currentTile == id)
+        currentTile = NO_TILE;
+    if (previousTile == id)
+        previousTile = NO_TILE;
+    // a region is selected by coordinates
+    if (region.empty() and not selectedTiles.empty()
+        and (floodSelection ? flood.contains(id)
+                            : std::find(selectedTiles.begin(), selectedTiles.end(), id) != selectedTiles.end())) {
+        selectedTiles.clear();
+        floodSelection = false;
+        freezeSelection = false;
+    }
+    tiles.erase(id);
+}
+
+void TileView::packChunk(const ChunkCoord &chunk, const ChunkData &data)
+{
+    ChunkData scratch;
+    if (not isSameChunk(data.data(), baseChunk(chunk, scratch)))
+        chunkCache.put(chunk, data);
+}
+
+const std::uint8_t *TileView::baseChunk(const ChunkCoord &chunk, const FloorEdit &edit, ChunkData &scratch) const
+{
+    if (edit.disable)
+        return nullptr;
+    if (const auto *saved = floor.find(chunk)) {
+        if (edit.isNone())
+            return saved;
+        std::copy(saved, saved + ChunkBits::SIZE, scratch.begin());
+    } else if (not pattern.isNone()) {
+        pattern.fill(chunk, scratch);
+    } else {
+        return nullptr;
+    }
+    edit.apply(scratch);
+    return scratch.data();
+}
+
+void TileView::restoreTiles(const TimeStamp &now, const ChunkCoord &chunk, const std::uint8_t *bits)
+{
+    ChunkBits::forEachEnabled(bits, [&](unsigned slot) {
+        auto tile = this->tile(tiles.insert(chunk.tile(slot)));
+        tile.setColor((TileColor) ChunkBits::color(bits, slot));
+        tile.setOrientation((Orientation) ChunkBits::orientation(bits, slot));
+        tile.start_enabling(now);
+    });
+}
+
+FloorUndo TileView::prepareFloorEdit(FloorOp op)
+{
+    // the tiles in the store are those of the resident chunks
+    finishBuilding();
+
+    FloorUndo undo;
+    undo.base = baseEdit;
+    undo.resident.assign(residentChunks.begin(), residentChunks.end());
+    std::sort(undo.resident.begin(), undo.resident.end());
+    // the other edits are undone by undoing op; disabled tiles are not packed
+    // and their colours are lost, so the chunks are kept as they were
+    if (op == FloorOp::Disable) {
+        // value initialized, a chunk without tiles is all zeros
+        std::unordered_map<ChunkCoord, ChunkData> resident;
+        for (const auto &chunk : residentChunks)
+            resident[chunk];
+        tiles.forEach([&](TileId id) {
+            if (not tiles.isEnabled(id))
+                return;
+            const auto &coord = tiles.coord(id);
+            ChunkBits::set(resident[ChunkCoord::of(coord)].data(), ChunkCoord::slot(coord),
+                           (unsigned) tiles.color(id), (unsigned) tiles.orientation(id), true);
+        });
+        undo.packed.assign(resident.begin(), resident.end());
+        chunkCache.forEach([&undo](const ChunkCoord &coord, const ChunkData &data) {
+            undo.packed.emplace_back(coord, data);
+        }, chunkLost);
+        std::sort(undo.packed.begin(), undo.packed.end(),
+                  [](const std::pair<ChunkCoord, ChunkData> &a, const std::pair<ChunkCoord, ChunkData> &b) {
+            return a.first < b.first;
+        });
+    }
+    return undo;
+}
+
+void TileView::editFloor(const TimeStamp &now, FloorOp op)
+{
+    finishBuilding();
+
+    switch (op) {
+    case FloorOp::None:
+        return;
+    case FloorOp::ColorUp:
+        bulkEdit(now, isVisible, [](TileStore::BulkTile &tile) { tile.changeColorUp(); });
+        break;
+    case FloorOp::ColorDown:
+        bulkEdit(now, isVisible, [](TileStore::BulkTile &tile) { tile.changeColorDown(); });
+        break;
+    case FloorOp::FlipOrientation:
+        bulkEdit(now, isOriented, [](TileStore::BulkTile &tile) { tile.changeOrientationUp(); });
+        break;
+    case FloorOp::Disable:
+        bulkEdit(now, [](const TileStore::BulkTile &) { return true; },
+                 [](TileStore::BulkTile &tile) { tile.start_disabling(); });
+        break;
+    }
+
+    // a disabled chunk is the same as its base, which has no tiles either
+    if (op == FloorOp::Disable) {
+        chunkCache.clear();
+    } else {
+        const auto edit = FloorEdit().then(op);
+        chunkCache.update([&edit](const ChunkCoord &, ChunkData &data) { edit.apply(data); }, chunkLost);
+    }
+    baseEdit = baseEdit.then(op);
+}
+
+void TileView::undoFloorEdit(const TimeStamp &now, FloorOp op, const FloorUndo &undo)
+{
+    finishBuilding();
+
+    // disabling cannot be inverted, the base before it is restored
+    const auto restored = op == FloorOp::Disable ? undo.base : baseEdit.then(FloorEdit::inverse(op));
+
+    ChunkData current, before;
+    if (op == FloorOp::Disable) {
+        for (const auto &chunk : undo.packed) {
+            if (residentChunks.count(chunk.first) != 0)
+                restoreTiles(now, chunk.first, chunk.second.data());
+            else if (not isSameChunk(chunk.second.data(), baseChunk(chunk.first, restored, before)))
+                chunkCache.put(chunk.first, chunk.second);
+        }
+        // read in from their base since
+        for (const auto &chunk : residentChunks)
+            if (undo.packedChunk(chunk) == nullptr)
+                if (const auto *bits = baseChunk(chunk, restored, before))
+                    restoreTiles(now, chunk, bits);
+        baseEdit = restored;
+        return;
+    }
+
+    // the chunks op found resident were restored tile by tile;
+    // the ones since left to their base keep what they have now
+    for (const auto &chunk : undo.resident) {
+        if (residentChunks.count(chunk) != 0 or chunkCache.contains(chunk))
+            continue;
+        const auto *bits = baseChunk(chunk, current);
+        if (isSameChunk(bits, baseChunk(chunk, restored, before)))
+            continue;
+        if (bits == nullptr)
+            current.fill(0);
+        else if (bits != current.data())
+            std::copy(bits, bits + ChunkBits::SIZE, current.begin());
+        chunkCache.put(chunk, current);
+    }
+
+    const auto edit = FloorEdit().then(FloorEdit::inverse(op));
+    tiles.forEach([&](TileId id) {
+        if (not tiles.isEnabled(id) or undo.wasResident(ChunkCoord::of(tiles.coord(id))))
+            return;
+        tiles.setColor(id, (TileColor) (((unsigned) tiles.color(id) + edit.shade) % 3));
+        if (edit.flip and tiles.orientation(id) != Orientation::Blank)
+            tiles.setOrientation(id, (Orientation) (3 - (int) tiles.orientation(id)));
+    });
+    chunkCache.update([&](const ChunkCoord &chunk, ChunkData &data) {
+        if (not undo.wasResident(chunk))
+            edit.apply(data);
+    }, chunkLost);
+    baseEdit = restored;
+}
+
+bool TileView::openFloor(const std::string &path)
+{
+    {
+        FloorFile check;
+        if (not check.open(path))
+            return false;
+    }
+    stopPrefetch();
+    if (not floor.open(path))
+        return false;
+
+    pattern = floor.getPattern();
+    resetTiles();
+    return true;
+}
+
+void TileView::newFloor(FloorPattern pattern)
+{
+    stopPrefetch();
+    floor.close();
+    this->pattern = pattern;
+    resetTiles();
+}
+
+void TileView::resetTiles()
+{
+    tiles.clear();
+    residentChunks.clear();
+    chunkCache.clear();
+    viewableTiles.clear();
+    ++viewableChanges;
+    selectedTiles.clear();
+    floodSelection = false;
+    freezeSelection = false;
+    region = RegionSelection();
+    currentTile = previousTile = NO_TILE;
+    randomCommands = 0;
+    baseEdit = FloorEdit();
+    pendingBlocks.clear();
+    building.active = false;
+
+    createMissingTiles(view);
+    if (viewTrans.isActive())
+        createMissingTiles(nextView);
+}
+
+bool TileView::saveFloor(const std::string &path)
+{
+    finishBuilding();
+
+    // value initialized, so new chunks start out zeroed
+    std::map<ChunkCoord, ChunkData> edited;
+    const bool complete = chunkCache.forEach([&edited](const ChunkCoord &coord, const ChunkData &data) {
+        edited[coord] = data;
+    });
+    // a design saved without some of its edits would pass for a complete one
+    if (not complete)
+        return false;
+    // on a pattern, a resident chunk without tiles differs from it
+    for (const auto &chunk : residentChunks)
+        edited[chunk];
+    tiles.forEach([&](TileId id) {
+        if (not tiles.isEnabled(id))
+            return;
+        const auto &coord = tiles.coord(id);
+        ChunkBits::set(edited[ChunkCoord::of(coord)].data(), ChunkCoord::slot(coord),
+                       (unsigned) tiles.color(id), (unsigned) tiles.orientation(id), true);
+    });
+
+    // the floor edits are saved with the chunks and the pattern
+    const auto savedPattern = baseEdit.apply(pattern);
+
+    // only the chunks that differ from the pattern are saved
+    std::vector<FloorFile::Chunk> chunks;
+    chunks.reserve(edited.size() + floor.chunkCount());
+    ChunkData patterned;
+    for (const auto &chunk : edited) {
+        const auto &data = chunk.second;
+        savedPattern.fill(chunk.first, patterned);
+        if (data != patterned)
+            chunks.emplace_back(chunk.first, data.data());
+    }
+    // the chunks of the open file that were not read or changed;
+    // the ones changed by floor edits are kept until they are written
+    std::deque<ChunkData> unread;
+    for (size_t i = 0; i < floor.chunkCount(); ++i) {
+        const auto coord = floor.chunkCoord(i);
+        const auto *bits = floor.chunk(i);
+        if (bits == nullptr or residentChunks.count(coord) != 0 or edited.count(coord) != 0)
+            continue;
+        if (not baseEdit.isNone()) {
+            unread.emplace_back();
+            std::copy(bits, bits + ChunkBits::SIZE, unread.back().begin());
+            baseEdit.apply(unread.back());
+            savedPattern.fill(coord, patterned);
+            if (unread.back() == patterned)
+                continue;
+            bits = unread.back().data();
+        }
+        chunks.emplace_back(coord, bits);
+    }
+    std::sort(chunks.begin(), chunks.end(), [](const FloorFile::Chunk &a, const FloorFile::Chunk &b) {
+        return a.first < b.first;
+    });
+
+    // the open file may be the one overwritten, and it stays mapped until the new one is complete
+    const auto temp = path + ".tmp";
+    if (not FloorFile::write(temp, chunks, savedPattern)) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    // the chunks read from the old file may be out of date
+    stopPrefetch();
+    floor.close();
+    pattern = savedPattern;
+    baseEdit = FloorEdit();
+    if (not FloorFile::replace(temp, path)) {
+        floor.open(temp);
+        return false;
+    }
+    // chunks that are not resident are read from the new file from now on
+    chunkCache.clear();
+    return floor.open(path);
+}
+
 void TileView::initView(const ViewCoords& vw, const ofVec2f &size)
 {
     view = vw;
@@ -77,26 +632,52 @@ void TileView::removeExtraTiles(const ViewCoords &view)
 {
     const auto windowRect = view.getViewRect(viewSize);
 
+    // the chunks of the view and the ones next to them stay resident
+    auto nearRange = TileParams::tile_range(viewSize, view.zoom, view.offset);
+    nearRange.rows.begin -= CHUNK_ROWS;
+    nearRange.rows.end += CHUNK_ROWS;
+    nearRange.cols.begin -= CHUNK_COLS;
+    nearRange.cols.end += CHUNK_COLS;
+    const auto first = ChunkCoord::of(TileCoord { nearRange.rows.begin, nearRange.cols.begin });
+    const auto last = ChunkCoord::of(TileCoord { nearRange.rows.end, nearRange.cols.end });
+
+    // a chunk packed away half built would lose the tiles not inserted yet
+    if (building.active and (building.chunk.row < first.row or building.chunk.row > last.row
+                             or building.chunk.col < first.col or building.chunk.col > last.col))
+        finishBuilding();
+
+    std::unordered_map<ChunkCoord, ChunkData> evicted;
+
     viewableTiles.clear();
+    ++viewableChanges;
+
+    // erasing only clears bits of the tile being visited, so it is safe inside forEach
+    tiles.forEach([&](TileId id) {
+        const auto tile = this->tile(id);
+        const bool inView = tile.isInRect(windowRect);
+        tiles.setViewable(id, inView);
+        if (inView) {
+            viewableTiles.push_back(id);
+            return;
+        }
 
-    auto tile = tiles.begin();
-    while (tile != tiles.end()) {
-        if (not tile->isInRect(windowRect)) {
-            if (not tile->isVisible()) {
-                tile->disconnect();
-                if (currentTile == &*tile)
-                    currentTile = nullptr;
-                if (previousTile == &*tile)
-                    previousTile = nullptr;
-                tile = tiles.erase(tile);
-                continue;
-            }
-        } else {
-            viewableTiles.push_back(&*tile);
+        const auto &coord = tiles.coord(id);
+        const auto chunk = ChunkCoord::of(coord);
+        const bool isFar = chunk.row < first.row or chunk.row > last.row or chunk.col < first.col or chunk.col > last.col;
+        if (isFar) {
+            auto &data = evicted[chunk];
+            if (tiles.isEnabled(id))
+                ChunkBits::set(data.data(), ChunkCoord::slot(coord),
+                               (unsigned) tiles.color(id), (unsigned) tiles.orientation(id), true);
         }
-        ++tile;
-    }
+
+        if (isFar or not tile.isVisible()) {
+            eraseTile(id);
+        }
+    });
     viewableTiles.shrink_to_fit();
+
+    evictChunks(evicted, nearRange);
 }
 
 void TileView::startMoving(const TimeStamp& now, const Duration &duration, float xoffset, float yoffset)
@@ -107,46 +688,61 @@ void TileView::startMoving(const TimeStamp& now, const Duration &duration, float
     nextView.offset.y += yoffset;
     nextView.roundOffsetTo(TileParams::X_STEP, TileParams::Y_STEP);
 
-    createMissingTiles(nextView);
+    queueMissingTiles(nextView);
+    prefetchAhead(now);
     viewTrans.stop().start(now, duration);
 }
 
 void TileView::startZooming(const TimeStamp &now, const Duration &duration, float newZoom)
+{
+    startZooming(now, duration, newZoom, ofVec2f(ofGetMouseX(), ofGetMouseY()));
+}
+
+void TileView::startZooming(const TimeStamp &now, const Duration &duration, float newZoom, const ofVec2f &anchor)
 {
     nextView = view;
     prevView = view;
-    nextView.setZoomWithOffset(newZoom, ofVec2f(ofGetMouseX(), ofGetMouseY()));
+    nextView.setZoomWithOffset(newZoom, anchor);
     nextView.roundOffsetTo(TileParams::X_STEP, TileParams::Y_STEP);
 
-
-    createMissingTiles(nextView);
+    queueMissingTiles(nextView);
+    prefetchAhead(now);
     viewTrans.stop().start(now, duration);
 }
 
-Tile* TileView::findTile(float x, float y)
+TileId TileView::findTile(const TileCoord &coord) const
+{
+    return tiles.find(coord);
+}
+
+TileId TileView::findTile(float x, float y) const
 {
     x /= view.zoom;
     y /= view.zoom;
     x += view.offset.x;
     y += view.offset.y;
 
-    if (currentTile != nullptr)
-        if (currentTile->isPointInside(x, y))
-            return currentTile;
-
-    auto found = std::find_if(tiles.begin(), tiles.end(), [x,y](auto &tile) {
-        return tile.isPointInside(x,y);
-    });
-
-    if (found == tiles.end())
-        return nullptr;
+    return findTile(TileParams::coord_at(x, y));
+}
 
-    return &*found;
+void TileView::findTiles(const ofRectangle &rect, std::vector<TileId> &found) const
+{
+    found.clear();
+    const auto rows = TileParams::row_range(rect.y, rect.y + rect.height);
+    const auto cols = TileParams::col_range(rect.x, rect.x + rect.width);
+
+    for (int row = rows.begin; row <= rows.end; ++row) {
+        for (int col = cols.begin; col <= cols.end; ++col) {
+            const auto id = tiles.find(TileCoord { row, col });
+            if (id != NO_TILE)
+                found.push_back(id);
+        }
+    }
 }
 
 void TileView::resizeView(const ofVec2f &size)
 {
-    currentTile = nullptr;
+    currentTile = NO_TILE;
     viewSize = size;
     createMissingTiles(view);
     if (not viewTrans.isActive())
@@ -157,10 +753,10 @@ void TileView::resizeView(const ofVec2f &size)
 void TileView::findCurrentTile(float x, float y)
 {
     currentTile = findTile(x, y);
-    if (currentTile != nullptr and currentTile != previousTile)
+    if (currentTile != NO_TILE and currentTile != previousTile)
     {
         if (enableFlood and freezeSelection) {
-            if (std::find(selectedTiles.begin(), selectedTiles.end(), currentTile) == selectedTiles.end()) {
+            if (not isSelected(currentTile)) {
                 freezeSelection = false;
             }
         }
@@ -173,9 +769,12 @@ void TileView::findCurrentTile(float x, float y)
 
 void TileView::updateSelected()
 {
+    if (not region.empty())
+        return;
     if (not enableFlood) {
+        floodSelection = false;
         selectedTiles.clear();
-        if (currentTile != nullptr) {
+        if (currentTile != NO_TILE) {
             selectedTiles.push_back(currentTile);
         }
     } else {
@@ -184,49 +783,94 @@ void TileView::updateSelected()
     }
 }
 
-void TileView::selectSimilarNeighbours(Tile* from)
+void TileView::selectSimilarNeighbours(TileId from)
 {
-    if (from == nullptr)
+    if (from == NO_TILE)
         return;
 
-    auto *found = &selectedTiles;
-    found->clear();
+    if (isFloodSelectionCurrent(from))
+        return;
 
-    std::set<Tile *> visited;
-    std::deque<Tile *> queue;
+    flood.run(tiles, from, selectedTiles);
+    floodSelection = true;
+    floodEdits = tiles.editCount();
+}
 
-    const auto state = from->getStateForFloodFill();
+// The selection stays the same while the start tile is part of it
+// and no tile of the selection or of its border was changed.
+bool TileView::isFloodSelectionCurrent(TileId from)
+{
+    if (not floodSelection or not flood.contains(from))
+        return false;
 
-    const auto is_same = [&state](Tile *tile) {
-        return tile->getStateForFloodFill() == state;
-    };
+    if (floodEdits == tiles.editCount())
+        return true;
 
-    const auto visit = [&visited](Tile *tile) {
-        return visited.insert(tile).second == true;
-    };
+    bool affected = false;
+    const bool logged = tiles.forEachEditSince(floodEdits, [this, &affected](TileId id) {
+        affected = affected or flood.isAffectedBy(tiles, id);
+    });
+    if (not logged or affected)
+        return false;
 
-    const auto push = [&queue, found](Tile *tile) {
-        found->push_back(tile);
-        queue.push_back(tile);
-    };
+    floodEdits = tiles.editCount();
+    return true;
+}
 
-    auto pop = [&queue]() -> Tile * {
-        if (queue.empty())
-            return nullptr;
-        const auto p = queue.front();
-        queue.pop_front();
-        return p;
-    };
+bool TileView::isSelected(TileId id) const
+{
+    if (not region.empty())
+        return region.contains(tiles.coord(id));
+    if (floodSelection)
+        return flood.contains(id);
+    return std::find(selectedTiles.begin(), selectedTiles.end(), id) != selectedTiles.end();
+}
 
-    push(from);
-    visit(from);
+void TileView::selectRegion(RegionSelection region)
+{
+    this->region = std::move(region);
+    floodSelection = false;
+    freezeSelection = false;
+    selectedTiles.clear();
+    updateSelected();
+}
 
-    while (auto *tile = pop()) {
-        for (auto *next : tile->getNeighbours()) {
-            if (visit(next) && is_same(next))
-                push(next);
-        }
-    }
+void TileView::clearRegion()
+{
+    if (region.empty())
+        return;
+    region = RegionSelection();
+    selectedTiles.clear();
+    updateSelected();
 }
 
+std::vector<ChunkCoord> TileView::regionChunks() const
+{
+    std::vector<ChunkCoord> chunks;
+    for (const auto &span : region.getSpans()) {
+        const auto first = ChunkCoord::of(TileCoord { span.row, span.col });
+        const auto last = ChunkCoord::of(TileCoord { span.row, span.col + (int) span.count - 1 });
+        for (int col = first.col; col <= last.col; ++col)
+            chunks.push_back(ChunkCoord { first.row, col });
+    }
+    std::sort(chunks.begin(), chunks.end());
+    chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+    return chunks;
+}
 
+void TileView::regionTiles(const ChunkCoord &chunk, std::vector<TileId> &ids)
+{
+    const auto corner = chunk.tile(0);
+    materializeChunks(TileParams::TileRange { { corner.row, corner.row }, { corner.col, corner.col } });
+
+    ids.clear();
+    const auto &spans = region.getSpans();
+    auto span = std::lower_bound(spans.begin(), spans.end(), corner.row,
+                                 [](const RegionSelection::Span &span, int row) { return span.row < row; });
+    for (; span != spans.end() and span->row < corner.row + CHUNK_ROWS; ++span) {
+        const int begin = std::max(span->col, corner.col);
+        const int end = std::min(span->col + (int) span->count, corner.col + CHUNK_COLS);
+        for (int col = begin; col < end; ++col)
+            ids.push_back(tiles.insert(TileCoord { span->row, col }));
+    }
+}
@@ -10,9 +10,22 @@
 
 #include "ViewCoords.h"
 #include "LinearTransition.h"
+#include "ChunkCache.h"
+#include "ChunkPrefetch.h"
+#include "FloodFill.h"
+#include "FloorEdit.h"
+#include "FloorFile.h"
+#include "RegionSelection.h"
 #include "Tile.h"
+#include "TileParams.h"
+#include "TileRandom.h"
+#include "TileStore.h"
+#include "WorkerPool.h"
 
-#include <list>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <functional>
@@ -24,36 +37,256 @@ struct TileView
 
     void createTiles();
     void createMissingTiles(const ViewCoords &view);
+    // queues the tiles of the view for createPendingTiles, the ones nearest to its centre first;
+    // replaces the tiles queued for another view
+    void queueMissingTiles(const ViewCoords &view);
+    // creates queued tiles until the budget is spent, at least one block of them,
+    // then with the time left the tiles of chunks read ahead of the view;
+    // returns false if no tiles were queued
+    bool createPendingTiles(const Duration &budget);
+    bool hasPendingTiles() const
+    {
+        return !pendingBlocks.empty();
+    }
+    // the areas of the tiles still queued, in view coordinates
+    template <typename F>
+    void forEachPendingArea(F f) const
+    {
+        for (const auto &block : pendingBlocks)
+            f(blockArea(block));
+    }
+    // erases the hidden tiles outside the view, and packs the chunks beyond
+    // the one around it into chunkCache, enabled tiles too
     void removeExtraTiles(const ViewCoords &view);
+    TileId addViewableTile(const TileCoord &coord);
+    // the tile at coord, created if needed; its chunk is read in even far from the view,
+    // removeExtraTiles packs it away again
+    TileId editableTile(const TileCoord &coord);
+
+    // Replaces the tiles with a saved design. Only the chunks around the view
+    // are read, the others when the view gets near them.
+    bool openFloor(const std::string &path);
+    // replaces the tiles with an unsaved design that is all pattern
+    void newFloor(FloorPattern pattern);
+    const FloorPattern &getPattern() const
+    {
+        return pattern;
+    }
+    // saves the tiles and the chunks of the open design that were not read
+    bool saveFloor(const std::string &path);
 
     void startMoving(const TimeStamp &now, const Duration &duration, float xoffset, float yoffset);
+    // zooms around the mouse, or around anchor in window coordinates
     void startZooming(const TimeStamp &now, const Duration &duration, float newZoom);
+    void startZooming(const TimeStamp &now, const Duration &duration, float newZoom, const ofVec2f &anchor);
 
-    Tile* findTile(float x, float y);
+    TileId findTile(const TileCoord &coord) const;
+    TileId findTile(float x, float y) const;
+    // tiles whose bounding box may overlap the rectangle, in view coordinates
+    void findTiles(const ofRectangle &rect, std::vector<TileId> &found) const;
     void findCurrentTile(float x, float y);
 
     void updateSelected();
-    void selectSimilarNeighbours(Tile* from);
+    void selectSimilarNeighbours(TileId from);
+    bool isSelected(TileId id) const;
+
+    // while a region is selected, its tiles are the selected tiles;
+    // it is kept as spans and only visited by forEachSelectedBatch
+    void selectRegion(RegionSelection region);
+    void clearRegion();
+    const RegionSelection &getRegion() const
+    {
+        return region;
+    }
+
+    Tile tile(TileId id)
+    {
+        return Tile(tiles, id);
+    }
+
+    // the selected tiles when no region is selected
+    TileList selected()
+    {
+        return TileList(tiles, selectedTiles);
+    }
+
+    size_t selectedCount() const
+    {
+        return region.empty() ? selectedTiles.size() : region.size();
+    }
+
+    // f(const std::vector<TileId> &) with the selected tiles. A region is visited
+    // chunk by chunk along its spans; a chunk that was packed away is read in
+    // for the call and packed again after it.
+    template <typename F>
+    void forEachSelectedBatch(F f);
+
+    TileList viewable()
+    {
+        return TileList(tiles, viewableTiles);
+    }
+
+    // Only the chunks around the view have their tiles in the store, the others
+    // are packed away (see removeExtraTiles); this does not reach them.
+    template <typename F>
+    void forEachResidentTile(F f)
+    {
+        tiles.forEach([this, &f](TileId id) { f(tile(id)); });
+    }
+
+    // Applies op to the whole floor: the tiles of the resident chunks with bulkEdit,
+    // the packed chunks in place, and the saved and pattern chunks as they are read in.
+    // prepareFloorEdit is called right before and returns what undoFloorEdit needs.
+    FloorUndo prepareFloorEdit(FloorOp op);
+    void editFloor(const TimeStamp &now, FloorOp op);
+    // undoes op outside the tiles it changed in resident chunks, once those are restored
+    void undoFloorEdit(const TimeStamp &now, FloorOp op, const FloorUndo &undo);
 
     ViewCoords view, prevView, nextView;
     ofVec2f viewSize;
 
     LinearTransition viewTrans;
 
-    std::list<Tile> tiles;
-    Tile* currentTile = nullptr;
-    Tile* previousTile = nullptr;
+    TileStore tiles;
+    TileId currentTile = NO_TILE;
+    TileId previousTile = NO_TILE;
 
     bool enableFlood = false;
     bool freezeSelection = false;
 
-    std::vector<Tile *> selectedTiles;
-    std::vector<Tile *> viewableTiles;
+    std::vector<TileId> selectedTiles;
+    std::vector<TileId> viewableTiles;
+    // changes whenever viewableTiles does
+    std::uint64_t viewableChanges = 0;
+
+    FloodFill flood { WorkerPool::shared() };
+    // selectedTiles holds the result of flood
+    bool floodSelection = false;
+    // TileStore::editCount() when the flood selection was last found to be up to date
+    std::uint64_t floodEdits = 0;
 
     std::function<void()> resetFocusStartTime = []{};
+    // called when the edits of a chunk packed away cannot be read back, the chunk is read from its base instead
+    std::function<void(const ChunkCoord &)> chunkLost = [](const ChunkCoord &) {};
 
-};
+    // the same seed and the same commands since the design was opened give the same floor
+    std::uint64_t randomSeed = 0;
+    // the random numbers of the next command that randomizes tiles
+    TileRandom nextRandom()
+    {
+        return TileRandom(randomSeed, randomCommands++);
+    }
+
+private:
+    // tiles queued together, about as wide as high
+    static constexpr int PENDING_BLOCK_ROWS = 16;
+    static constexpr int PENDING_BLOCK_COLS = 4;
 
+    // chunks are read ahead as far as the view goes in this time at its speed,
+    // at most one chunk beyond the view
+    static constexpr float PREFETCH_AHEAD_SECONDS = 0.5f;
+    // moves further apart do not make a speed
+    static constexpr float MAX_MOVE_INTERVAL_SECONDS = 0.5f;
 
+    static ofRectangle blockArea(const TileParams::TileRange &block);
+
+    // edits the resident tiles that satisfy predicate on all cores, see TileStore::bulkEdit;
+    // editFloor does the rest of the floor
+    template <typename P, typename E>
+    void bulkEdit(const TimeStamp &now, P predicate, E edit)
+    {
+        tiles.bulkEdit(WorkerPool::shared(), now, TILE_ENABLE_DURATION, TILE_DISABLE_DURATION, predicate, edit);
+    }
+
+    // asks prefetch for the chunks around nextView, more of them in the direction it moves
+    void prefetchAhead(const TimeStamp &now);
+    // before the floor is closed or replaced
+    void stopPrefetch();
+    // inserts the next tiles of building until the budget is spent; returns true when all are in
+    bool buildChunk(const TimeStamp &start, const Duration &budget);
+    void finishBuilding();
+    void insertChunkTile(const ChunkCoord &chunk, const std::uint8_t *bits, unsigned slot);
+    void resetTiles();
+    // the chunks the spans of the region cross, sorted
+    std::vector<ChunkCoord> regionChunks() const;
+    // the tiles of the region in the chunk, which is read in
+    void regionTiles(const ChunkCoord &chunk, std::vector<TileId> &ids);
+    // the tiles of a chunk that was not edited: saved, or else of the pattern,
+    // with the floor edits since; nullptr if there are none
+    const std::uint8_t *baseChunk(const ChunkCoord &chunk, ChunkData &scratch) const
+    {
+        return baseChunk(chunk, baseEdit, scratch);
+    }
+    const std::uint8_t *baseChunk(const ChunkCoord &chunk, const FloorEdit &edit, ChunkData &scratch) const;
+    // enables the tiles of a resident chunk that are enabled in bits
+    void restoreTiles(const TimeStamp &now, const ChunkCoord &chunk, const std::uint8_t *bits);
+    bool isFloodSelectionCurrent(TileId from);
+    void materializeChunks(const TileParams::TileRange &range);
+    void evictChunks(std::unordered_map<ChunkCoord, ChunkData> &evicted, const TileParams::TileRange &range);
+    // packs the tiles of a resident chunk away from the view
+    void evictChunk(const ChunkCoord &chunk);
+    // erases a tile, and the selection if the tile is part of it
+    void eraseTile(TileId id);
+    // keeps the packed tiles of a chunk that is no longer resident if they differ from its base
+    void packChunk(const ChunkCoord &chunk, const ChunkData &data);
+
+    // The tiles of the chunks around the view are in tiles.
+    // Chunks left behind are packed into chunkCache if they differ from floor
+    // and pattern, and are read back from there or from floor or pattern
+    // when the view returns.
+    static constexpr size_t CACHED_CHUNKS_IN_MEMORY = 256;
+
+    std::uint64_t randomCommands = 0;
+
+    // blocks of tiles of nextView not created yet, the nearest to its centre last
+    std::vector<TileParams::TileRange> pendingBlocks;
+
+    RegionSelection region;
+
+    FloorFile floor;
+    FloorPattern pattern;
+    // the floor edits made since floor was opened or saved, applied to its chunks
+    // and to the pattern whenever they are read in
+    FloorEdit baseEdit;
+    std::unordered_set<ChunkCoord> residentChunks;
+    ChunkCache chunkCache { CACHED_CHUNKS_IN_MEMORY };
+
+    ChunkPrefetch prefetch;
+    // chunks read by prefetch that are not resident yet, as saved or of the pattern,
+    // without baseEdit
+    std::unordered_map<ChunkCoord, ChunkData> prefetched;
+    // A chunk read ahead whose tiles are inserted over several frames, in the order
+    // of their enabled bytes; the chunk is resident once all of them are in.
+    struct Building
+    {
+        bool active = false;
+        ChunkCoord chunk;
+        ChunkData data;
+        unsigned nextByte = 0;
+    };
+    Building building;
+    // the centre of nextView when it was last set, and the speed it moved at
+    ofVec2f lastTarget;
+    TimeStamp lastTargetTime;
+    ofVec2f velocity;
+
+};
+
+template <typename F>
+void TileView::forEachSelectedBatch(F f)
+{
+    if (region.empty()) {
+        f(selectedTiles);
+        return;
+    }
+    std::vector<TileId> ids;
+    for (const auto &chunk : regionChunks()) {
+        const bool resident = residentChunks.count(chunk) != 0;
+        regionTiles(chunk, ids);
+        f(ids);
+        if (not resident)
+            evictChunk(chunk);
+    }
+}
 
 #endif /* SRC_TILEVIEW_H_ */
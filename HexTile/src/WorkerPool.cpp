@@ -0,0 +1,96 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+static thread_local bool insideSlice = false;
+
+WorkerPool &WorkerPool::shared()
+{
+    static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+WorkerPool::WorkerPool(unsigned threads)
+{
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back([this] { run(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void WorkerPool::parallel_for(size_t count, size_t grain, const Slice &slice)
+{
+    grain = std::max<size_t>(grain, 1);
+    if (count == 0)
+        return;
+    if (workers.empty() || count <= grain || insideSlice) {
+        for (size_t begin = 0; begin < count; begin += grain)
+            slice(begin, std::min(begin + grain, count));
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(callMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &slice;
+        jobCount = count;
+        jobGrain = grain;
+        next = 0;
+        pending = (unsigned) workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::work()
+{
+    insideSlice = true;
+    for (;;) {
+        const size_t begin = next.fetch_add(jobGrain);
+        if (begin >= jobCount)
+            break;
+        (*job)(begin, std::min(begin + jobGrain, jobCount));
+    }
+    insideSlice = false;
+}
+
+void WorkerPool::run()
+{
+    unsigned seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this, &seen] { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+
+        lock.unlock();
+        work();
+        lock.lock();
+
+        if (--pending == 0)
+            done.notify_one();
+    }
+}
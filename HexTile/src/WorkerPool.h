@@ -0,0 +1,65 @@
+/*
+ * WorkerPool.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+#ifndef SRC_WORKERPOOL_H_
+#define SRC_WORKERPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that run slices of an index range.
+// The calling thread takes part in the work and parallel_for returns
+// only when every slice is done. Calls from inside a slice run inline.
+class WorkerPool
+{
+public:
+    using Slice = std::function<void(size_t begin, size_t end)>;
+
+    // one thread per core, including the caller
+    static WorkerPool &shared();
+
+    explicit WorkerPool(unsigned threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator =(const WorkerPool &) = delete;
+
+    // number of threads that work on a job, including the caller
+    unsigned size() const
+    {
+        return (unsigned) workers.size() + 1;
+    }
+
+    // calls slice(begin, end) for consecutive ranges of at most grain indices in [0, count)
+    void parallel_for(size_t count, size_t grain, const Slice &slice);
+
+private:
+    void run();
+    void work();
+
+    std::vector<std::thread> workers;
+
+    std::mutex callMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const Slice *job = nullptr;
+    size_t jobCount = 0;
+    size_t jobGrain = 1;
+    std::atomic<size_t> next { 0 };
+    unsigned pending = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+};
+
+#endif /* SRC_WORKERPOOL_H_ */
@@ -1,10 +1,71 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "AppConsts.h"
+#include "FloorFile.h"
+#include "FrameScheduler.h"
+#include "PosterExport.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static constexpr float DEFAULT_POSTER_DPI = 300;
+
+// HexTile --export design.hexfloor poster.png [dpi [left,top,width,height]]
+// prints the design into the image without opening a window;
+// the area is in mm on the floor, and is required for designs on a pattern
+static int exportPoster(int argc, char *argv[])
+{
+    if (argc < 4) {
+        std::cerr << "usage: HexTile --export design.hexfloor poster.png [dpi [left,top,width,height]]" << std::endl;
+        return 2;
+    }
+    const float dpi = argc > 4 ? (float) std::atof(argv[4]) : DEFAULT_POSTER_DPI;
+    if (!(dpi > 0)) {
+        std::cerr << "invalid dpi: " << argv[4] << std::endl;
+        return 2;
+    }
+    float left, top, width, height;
+    if (argc > 5 && (std::sscanf(argv[5], "%f,%f,%f,%f", &left, &top, &width, &height) != 4
+                     || !(width > 0) || !(height > 0))) {
+        std::cerr << "invalid area: " << argv[5] << std::endl;
+        return 2;
+    }
+
+    FloorFile floor;
+    if (!floor.open(argv[2])) {
+        std::cerr << "cannot open " << argv[2] << std::endl;
+        return 1;
+    }
+    PosterExport poster(floor);
+    if (argc > 5) {
+        poster.setArea(ofRectangle(left * PIX_PER_MM, top * PIX_PER_MM, width * PIX_PER_MM, height * PIX_PER_MM));
+    } else if (poster.isPatterned()) {
+        std::cerr << argv[2] << " is on a pattern without end, give the area to print" << std::endl;
+        return 2;
+    } else if (poster.getBounds().isEmpty()) {
+        std::cerr << argv[2] << " has no tiles" << std::endl;
+        return 1;
+    }
+    if (!poster.loadImages(ofFilePath::join(ofFilePath::getCurrentExeDir(), "images")))
+        std::cerr << "tile images not found, using flat colours" << std::endl;
+
+    std::cout << "exporting " << poster.width(dpi) << " x " << poster.height(dpi) << " px" << std::endl;
+    if (!poster.write(argv[3], dpi)) {
+        std::cerr << "cannot write " << argv[3] << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
 //========================================================================
-int main() {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--export")
+        return exportPoster(argc, argv);
+
     ofSetupOpenGL(1024, 768, OF_WINDOW);			// <-------- setup the GL context
-    ofSetFrameRate(120);
+    ofSetFrameRate(FrameScheduler::ACTIVE_FRAME_RATE);
     ofSetVerticalSync(true);
     ofSetEscapeQuitsApp(false);
 
@@ -3,6 +3,7 @@
 #include "ZoomLevels.h"
 
 #include <ofFileUtils.h>
+#include <ofSystemUtils.h>
 
 #include <array>
 #include <algorithm>
@@ -23,6 +24,22 @@ static constexpr auto ARROW_SHORT_LENGTH_PERIOD = 0.75s;
 static constexpr auto ARROW_LONG_LENGTH_PERIOD = 1.5s;
 
 constexpr auto VIEW_TRANS_DURATION = 125ms;
+// time per frame spent creating the tiles of a new view
+static constexpr auto TILE_CREATION_BUDGET = 2ms;
+
+static constexpr auto FLOOR_FILE_EXT = ".hexfloor";
+
+// lasso points closer than this on the screen are dropped
+static constexpr float LASSO_STEP_PIX = 4;
+// regions of more tiles are only outlined
+static constexpr size_t MAX_FOCUSED_REGION_TILES = 4096;
+// walkers added to the crowd at a time
+static constexpr size_t CROWD_STEP = 1000;
+
+static ofRectangle spanned(const ofVec2f &a, const ofVec2f &b)
+{
+    return ofRectangle(std::min(a.x, b.x), std::min(a.y, b.y), std::abs(b.x - a.x), std::abs(b.y - a.y));
+}
 
 static
 const auto zoom_levels = ZoomLevels::generate(6);
@@ -63,15 +80,20 @@ void ofApp::setup()
     };
 
     concrete.load(imagefile("concrete.jpg"));
+    background.setImage(&concrete);
 
     tileImages.black.load(imagefile("black.png"));
     tileImages.grey.load(imagefile("grey.png"));
     tileImages.white.load(imagefile("white.png"));
+    tileBatch.setImages(&tileImages);
+    damageBatch.setImages(&tileImages);
+    chunkImages.setImages(&tileImages);
 
     sticky.images.resize(4);
     for (auto i : {0, 1, 2})
         sticky.images[i].load(imagefile("sticky" + std::to_string(i) + ".png"));
     sticky.images[3] = sticky.images[1];
+    crowd.setImages(&sticky.images);
 
     tv.initView(ViewCoords{zoom_levels[zoomLevel = default_zoom_level()],
                            ofVec2f{0,0}},
@@ -80,8 +102,12 @@ void ofApp::setup()
     tv.createTiles();
     resizeFrameBuffer(ofGetWidth(), ofGetHeight());
 
-    tv.currentTile = nullptr;
+    tv.currentTile = NO_TILE;
     tv.resetFocusStartTime = [this]{focus_start = Clock::now();};
+    tv.chunkLost = [](const ChunkCoord &chunk) {
+        ofLogError("HexTile") << "lost the edits of chunk " << chunk.row << ", " << chunk.col
+                              << ": cannot read them back from the chunk cache";
+    };
 }
 
 
@@ -92,70 +118,46 @@ void ofApp::update()
 {
     const auto now = Clock::now();
 
-    if (tv.viewTrans.isActive()) {
-        if (tv.viewTrans.update(now)) {
-            auto blend = sin(M_PI * tv.viewTrans.getValue() / 2);
-            tv.view = ViewCoords::blend(tv.prevView, tv.nextView, blend);
-            findCurrentTile();
-        } else {
-            tv.prevView = tv.view = tv.nextView;
-            tv.removeExtraTiles(tv.view);
+    {
+        FrameTimers::Scope timer(frameTimers, FramePhase::Update);
+
+        if (tv.viewTrans.isActive()) {
+            if (tv.viewTrans.update(now)) {
+                auto blend = sin(M_PI * tv.viewTrans.getValue() / 2);
+                tv.view = ViewCoords::blend(tv.prevView, tv.nextView, blend);
+                findCurrentTile();
+            } else {
+                tv.prevView = tv.view = tv.nextView;
+                tv.removeExtraTiles(tv.view);
+                findCurrentTile();
+            }
+            redrawFramebuffer = true;
+        }
+
+        if (tv.createPendingTiles(TILE_CREATION_BUDGET)) {
             findCurrentTile();
+            redrawFramebuffer = true;
         }
-        redrawFramebuffer = true;
-    }
 
-    if (sticky.visible)
-    {
-        updateSticky();
-        sticky.updateStep(now);
+        if (sticky.visible)
+        {
+            updateSticky();
+            sticky.updateStep(now);
+        }
     }
 
-    tv.updateSelected();
-}
-
-void ofApp::drawBackground()
-{
-    if (concrete.isAllocated())
-    {
-        const auto &viewSize = tv.viewSize;
-        const auto &view = tv.view;
-        ofSetColor(240);
-        ofRectangle winrect(0, 0, viewSize.x, viewSize.y);
-        ofRectangle slab { 0, 0, concrete.getWidth(), concrete.getHeight()};
-        slab.scale(BG_SCALE * view.zoom, BG_SCALE * view.zoom);
-        float offsetx = std::fmod(-view.offset.x * view.zoom, slab.width);
-        if (offsetx > 0)
-            offsetx -= slab.width;
-
-        float offsety = std::fmod(-view.offset.y * view.zoom, slab.width);
-        if (offsety > 0)
-            offsety -= slab.height;
-
-        for (slab.x = offsetx; slab.x < winrect.width; slab.x += slab.width)
-            for (slab.y = offsety; slab.y < winrect.width; slab.y += slab.height)
-                concrete.draw(slab);
-    }
-    else
     {
-        ofBackgroundGradient(ofColor { 120, 120, 120 }, ofColor { 160, 160, 160 });
+        FrameTimers::Scope timer(frameTimers, FramePhase::UpdateSelected);
+        tv.updateSelected();
     }
-}
 
-void ofApp::drawShadows()
-{
-    ofSetLineWidth(LINE_WIDTH_PIX * tv.view.zoom);
-    ofPushMatrix();
-    ofTranslate(LINE_WIDTH_PIX / 2, LINE_WIDTH_PIX / 2);
-    for (auto* tile : tv.viewableTiles)
     {
-        if (tile->isVisible())
-        {
-            ofSetColor(ofColor(0, 0, 0, 128 * tile->alpha));
-            tile->draw();
-        }
+        FrameTimers::Scope timer(frameTimers, FramePhase::UpdateCrowd);
+        crowd.update(tv, now);
     }
-    ofPopMatrix();
+
+    frameScheduler.update(now, redrawFramebuffer or sticky.visible or not crowd.empty() or tv.hasPendingTiles()
+                          or not tv.tiles.isIdle());
 }
 
 void ofApp::drawSticky()
@@ -169,8 +171,9 @@ void ofApp::drawSticky()
             sticky.drawNormal(TILE_RADIUS_PIX + TILE_RADIUS_PIX/5 * getFocusAlpha(ARROW_LONG_LENGTH_PERIOD), 15);
         }
     }
+    ofSetColor(255);
+    crowd.draw();
     if (sticky.visible) {
-        ofSetColor(255);
         sticky.draw();
     }
 }
@@ -206,8 +209,16 @@ void ofApp::drawInfo()
         << "View       : " << (int)viewrect_mm.width << "mm x " << (int)viewrect_mm.height << "mm"
                            << " @ " << (int)viewrect_mm.x << "mm, " << (int)viewrect_mm.y << "mm\n"
         << "Tiles      : " << tiles.size() << "\n"
+        << "Selected   : " << tv.selectedCount() << "\n"
+        << "Walkers    : " << crowd.size() << "\n"
         << "Frame rate : " << std::fixed << std::setprecision(2) << ofGetFrameRate() << " fps";
         ;
+    for (size_t i = 0; i < FrameTimers::PHASES; ++i) {
+        const auto phase = (FramePhase) i;
+        info << "\n" << std::left << std::setw(18) << FrameTimers::name(phase) << std::right
+             << ": p50 " << std::setprecision(2) << frameTimers.quantile(phase, 0.5f) << "ms"
+             << ", p99 " << frameTimers.quantile(phase, 0.99f) << "ms";
+    }
     const ofVec2f pos(2, ofGetViewportHeight() - 2);
     drawBottomText(info.str(), pos);
 }
@@ -216,20 +227,52 @@ void ofApp::drawFocus()
 {
     auto shift = ::shift();
 
+    if (selecting or not tv.getRegion().empty()) {
+        drawRegion();
+        return;
+    }
     if (!tv.enableFlood) {
-        drawTileFocus(tv.currentTile, shift);
+        if (tv.currentTile != NO_TILE)
+            drawTileFocus(tv.tile(tv.currentTile), shift);
     } else {
-        for (auto *tile : tv.selectedTiles) {
+        for (auto tile : tv.selected()) {
             drawTileFocus(tile, shift);
         }
     }
 }
 
-void ofApp::drawTileFocus(Tile * tile, bool shift)
+void ofApp::drawRegion()
 {
-    if (tile == nullptr)
-        return;
+    const auto &region = tv.getRegion();
+    if (not selecting and region.size() <= MAX_FOCUSED_REGION_TILES)
+        region.forEach([this](const TileCoord &coord) {
+            const auto id = tv.findTile(coord);
+            if (id != NO_TILE)
+                drawTileFocus(tv.tile(id), shift());
+        });
+
+    std::vector<ofVec2f> outline;
+    if (selecting and selectTool == SelectTool::Rectangle and selectOutline.size() == 2) {
+        const auto &a = selectOutline[0];
+        const auto &b = selectOutline[1];
+        outline = { a, ofVec2f(b.x, a.y), b, ofVec2f(a.x, b.y) };
+    } else {
+        outline = selecting ? selectOutline : region.getOutline();
+    }
+
+    ofPushStyle();
+    ofNoFill();
+    ofSetLineWidth(1.5f);
+    ofSetColor(getFocusColorMix(ofColor(32, 32, 32, 196), ofColor(240, 240, 240, 240), ARROW_COLOR_PERIOD));
+    ofBeginShape();
+    for (const auto &point : outline)
+        ofVertex(point.x, point.y);
+    ofEndShape(true);
+    ofPopStyle();
+}
 
+void ofApp::drawTileFocus(Tile tile, bool shift)
+{
     const auto getFocusGray = [shift](const TileColor color) -> unsigned char {
         switch (color) {
         case TileColor::Gray:
@@ -243,14 +286,14 @@ void ofApp::drawTileFocus(Tile * tile, bool shift)
         }
     };
 
-    if (tile->enabled or tile->in_transition) {
-        ofSetColor(getFocusColor(getFocusGray(tile->color), tile->alpha));
-        tile->fill();
+    if (tile.enabled() or tile.in_transition()) {
+        ofSetColor(getFocusColor(getFocusGray(tile.color()), tile.alpha()));
+        tile.fill();
     }
-    if (not tile->enabled or tile->in_transition) {
-        ofSetColor(getFocusColor(!shift ? 255 : 0 , 1 - tile->alpha));
+    if (not tile.enabled() or tile.in_transition()) {
+        ofSetColor(getFocusColor(!shift ? 255 : 0 , 1 - tile.alpha()));
         ofSetLineWidth(1.5 * tv.view.zoom);
-        tile->draw();
+        tile.draw();
     }
 }
 
@@ -261,23 +304,53 @@ void ofApp::resizeFrameBuffer(int w, int h)
     redrawFramebuffer = true;
 }
 
-// b == a * ( 1 - alpha ) + x * alpha
-// c == b * ( 1 - alpha ) + x * alpha
-//   == (a * ( 1 - alpha ) + x * alpha) * (1 - alpha) + x * alpha
-//   == a * (1 - (2*alpha - alpha^2) ) + x * (2*alpha - alpha^2)
+void ofApp::openFloor(const std::string &path)
+{
+    if (not tv.openFloor(path)) {
+        ofLogError("HexTile") << "cannot open floor design " << path;
+        return;
+    }
+    ofSetWindowTitle("HexTile - " + ofFilePath::getFileName(path));
+    history.clear();
+    redrawFramebuffer = true;
+}
 
-template <typename T>
-inline T doubleAlpha(const T &alpha) {
-    return 2 * alpha - alpha * alpha;
+void ofApp::newFloor(FloorPattern pattern)
+{
+    tv.newFloor(pattern);
+    ofSetWindowTitle("HexTile");
+    history.clear();
+    redrawFramebuffer = true;
 }
 
-void ofApp::drawToFramebuffer()
+void ofApp::saveFloor()
 {
-    ofPushStyle();
-    frameBuffer.begin();
+    auto result = ofSystemSaveDialog("floor" + std::string(FLOOR_FILE_EXT), "Save floor design");
+    if (not result.bSuccess)
+        return;
+    auto path = result.getPath();
+    if (ofFilePath::getFileExt(path).empty())
+        path += FLOOR_FILE_EXT;
+    if (not tv.saveFloor(path)) {
+        ofLogError("HexTile") << "cannot save floor design " << path;
+        return;
+    }
+    history.floorSaved();
+    ofSetWindowTitle("HexTile - " + ofFilePath::getFileName(path));
+}
 
-    drawBackground();
+void ofApp::saveFrameTimes()
+{
+    const auto path = ofToDataPath("frametimes-" + ofGetTimestampString() + ".csv", true);
+    if (not frameTimers.writeCsv(path)) {
+        ofLogError("HexTile") << "cannot save frame times " << path;
+        return;
+    }
+    ofLogNotice("HexTile") << "frame times saved to " << path;
+}
 
+void ofApp::drawTiles(const TileBatch &batch)
+{
     ofEnableSmoothing();
     ofEnableAntiAliasing();
     ofEnableAlphaBlending();
@@ -287,30 +360,124 @@ void ofApp::drawToFramebuffer()
     ofPushMatrix();
     view.applyToCurrentMatrix();
 
-    drawShadows();
+    batch.draw(view.zoom);
 
-    const auto &viewableTiles = tv.viewableTiles;
+    ofPopMatrix();
+}
 
-    for (auto * tile : viewableTiles) {
-        if (tile->isVisible()) {
-            tile->fill(tileImages);
-        }
-    }
+void ofApp::drawToFramebuffer()
+{
+    const bool lod = ChunkImages::isUsedAt(tv.view.zoom);
+    if (lod)
+        chunkImages.refresh(tv);
 
-    ofSetLineWidth(LINE_WIDTH_PIX * view.zoom);
-    for (auto * tile : viewableTiles) {
-        if (tile->isVisible()) {
-            const float lineAlpha = tile->alpha * 160 / 255;
-            ofSetColor(20, 20, 20, 255 * lineAlpha);
-            tile->draw();
+    background.refresh(tv.view, tv.viewSize);
 
-            // as if drawn 2 times
-            ofSetColor(20, 20, 20, 255 * doubleAlpha(lineAlpha));
-            tile->drawCubeIllusion();
-        }
+    ofPushStyle();
+    frameBuffer.begin();
+
+    background.draw(tv.view);
+
+    if (lod) {
+        ofPushMatrix();
+        tv.view.applyToCurrentMatrix();
+        chunkImages.draw(tv);
+        ofPopMatrix();
+    } else {
+        tileBatch.update(tv.tiles, tv.viewableTiles, tv.viewableChanges);
+        drawTiles(tileBatch);
     }
+    drawPendingTiles();
+
+    frameBuffer.end();
+    ofPopStyle();
+}
+
+// a flat veil over the areas whose tiles are not created yet, one draw call
+void ofApp::drawPendingTiles()
+{
+    if (not tv.hasPendingTiles())
+        return;
+
+    const auto viewRect = tv.view.getViewRect(tv.viewSize);
+    pendingMesh.clear();
+    pendingMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    tv.forEachPendingArea([this, &viewRect](const ofRectangle &area) {
+        if (not area.intersects(viewRect))
+            return;
+        const auto first = (unsigned) pendingMesh.getNumVertices();
+        pendingMesh.addVertex(ofVec3f(area.x, area.y));
+        pendingMesh.addVertex(ofVec3f(area.x + area.width, area.y));
+        pendingMesh.addVertex(ofVec3f(area.x + area.width, area.y + area.height));
+        pendingMesh.addVertex(ofVec3f(area.x, area.y + area.height));
+        for (unsigned i : { 0, 1, 2, 0, 2, 3 })
+            pendingMesh.addIndex(first + i);
+    });
 
+    ofPushStyle();
+    ofEnableAlphaBlending();
+    ofSetColor(96, 96, 96, 128);
+    ofPushMatrix();
+    tv.view.applyToCurrentMatrix();
+    pendingMesh.draw();
     ofPopMatrix();
+    ofPopStyle();
+}
+
+void ofApp::collectDamage()
+{
+    const auto &tiles = tv.tiles;
+    const auto add = [this, &tiles](TileId id) {
+        damage.add(TileParams::drawn_box(tiles.coord(id)));
+    };
+
+    if (not redrawFramebuffer) {
+        if (not tiles.forEachEditSince(drawnEdits, add))
+            redrawFramebuffer = true;
+        tiles.forEachInTransition(add);
+    }
+    drawnEdits = tiles.editCount();
+
+    // past half of the view it is cheaper to redraw everything,
+    // and with chunk images only a few quads are drawn anyway
+    const auto viewRect = tv.view.getViewRect(tv.viewSize);
+    if (damage.area() > viewRect.width * viewRect.height / 2
+        or (not damage.empty() and ChunkImages::isUsedAt(tv.view.zoom)))
+        redrawFramebuffer = true;
+}
+
+void ofApp::drawDamageToFramebuffer()
+{
+    const auto &view = tv.view;
+    const int width = (int) frameBuffer.getWidth();
+    const int height = (int) frameBuffer.getHeight();
+
+    background.refresh(view, tv.viewSize);
+
+    ofPushStyle();
+    frameBuffer.begin();
+    glEnable(GL_SCISSOR_TEST);
+
+    for (const auto &rect : damage.getRects()) {
+        // pixels covered by the rectangle, with a margin for antialiasing
+        const int left = std::max(0, (int) std::floor((rect.x - view.offset.x) * view.zoom) - 1);
+        const int top = std::max(0, (int) std::floor((rect.y - view.offset.y) * view.zoom) - 1);
+        const int right = std::min(width, (int) std::ceil((rect.x + rect.width - view.offset.x) * view.zoom) + 1);
+        const int bottom = std::min(height, (int) std::ceil((rect.y + rect.height - view.offset.y) * view.zoom) + 1);
+        if (left >= right or top >= bottom)
+            continue;
+
+        // GL counts the rows from the bottom
+        glScissor(left, height - bottom, right - left, bottom - top);
+
+        tv.findTiles(rect, damagedTiles);
+        damageBatch.build(tv.tiles, damagedTiles);
+
+        background.draw(view);
+        drawTiles(damageBatch);
+    }
+
+    glDisable(GL_SCISSOR_TEST);
     frameBuffer.end();
     ofPopStyle();
 }
@@ -318,15 +485,23 @@ void ofApp::drawToFramebuffer()
 void ofApp::draw()
 {
     auto now = Clock::now();
-    bool rfb = false;
-    for (auto * tile : tv.viewableTiles)
-        rfb |= tile->update_alpha(now);
-    redrawFramebuffer |= rfb;
-
-    if (redrawFramebuffer) {
-        drawToFramebuffer();
-        redrawFramebuffer = false;
+    // the damage of fading tiles is collected before their last step
+    collectDamage();
+    {
+        FrameTimers::Scope timer(frameTimers, FramePhase::UpdateAlpha);
+        tv.tiles.update_alpha(now);
+    }
+
+    {
+        FrameTimers::Scope timer(frameTimers, FramePhase::DrawToFramebuffer);
+        if (redrawFramebuffer) {
+            drawToFramebuffer();
+            redrawFramebuffer = false;
+        } else if (not damage.empty()) {
+            drawDamageToFramebuffer();
+        }
     }
+    damage.clear();
 
     ofPushStyle();
     ofDisableAlphaBlending();
@@ -337,12 +512,19 @@ void ofApp::draw()
 
     ofPushMatrix();
     tv.view.applyToCurrentMatrix();
-    drawFocus();
-    drawSticky();
+    {
+        FrameTimers::Scope timer(frameTimers, FramePhase::DrawFocus);
+        drawFocus();
+    }
+    {
+        FrameTimers::Scope timer(frameTimers, FramePhase::DrawSticky);
+        drawSticky();
+    }
     ofPopMatrix();
 
     drawInfo();
 
+    frameTimers.endFrame();
 }
 
 constexpr int KEY_CTRL_(const char ch)
@@ -353,10 +535,9 @@ constexpr int KEY_CTRL_(const char ch)
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key)
 {
-    auto &selectedTiles = tv.selectedTiles;
+    frameScheduler.wake(Clock::now());
     auto &freezeSelection = tv.freezeSelection;
     auto &enableFlood = tv.enableFlood;
-    auto &tiles = tv.tiles;
     const auto &view = tv.view;
 
     auto now = Clock::now();
@@ -364,13 +545,14 @@ void ofApp::keyPressed(int key)
     switch (key) {
     case 'i':
     case 'I':
-        for (auto *tile : selectedTiles) {
-            if (tile->isVisible()) {
-                tile->invertColor();
-                freezeSelection = true;
-                redrawFramebuffer = true;
+        editSelected([&](TileList selected) {
+            for (auto tile : selected) {
+                if (tile.isVisible()) {
+                    tile.invertColor();
+                    freezeSelection = true;
+                }
             }
-        }
+        });
         break;
     case 'h':
     case 'H':
@@ -378,110 +560,104 @@ void ofApp::keyPressed(int key)
         break;
     case 'W':
     case 'w':
-        for (auto *tile : selectedTiles) {
-            tile->color = TileColor::White;
-            if (not tile->isVisible())
-                tile->orientation = Orientation::Blank;
-            tile->start_enabling(now);
-        }
+        editSelected([&](TileList selected) {
+            for (auto tile : selected) {
+                tile.setColor(TileColor::White);
+                if (not tile.isVisible())
+                    tile.setOrientation(Orientation::Blank);
+                tile.start_enabling(now);
+            }
+        });
         freezeSelection = true;
-        redrawFramebuffer = true;
         break;
     case 'B':
     case 'b':
-        for (auto *tile : selectedTiles) {
-            tile->color = TileColor::Black;
-            if (not tile->isVisible())
-                tile->orientation = Orientation::Blank;
-            tile->start_enabling(now);
-        }
+        editSelected([&](TileList selected) {
+            for (auto tile : selected) {
+                tile.setColor(TileColor::Black);
+                if (not tile.isVisible())
+                    tile.setOrientation(Orientation::Blank);
+                tile.start_enabling(now);
+            }
+        });
         freezeSelection = true;
-        redrawFramebuffer = true;
         break;
     case 'G':
     case 'g':
-        for (auto *tile : selectedTiles) {
-            tile->color = TileColor::Gray;
-            if (not tile->isVisible())
-                tile->orientation = Orientation::Blank;
-            tile->start_enabling(now);
-        }
+        editSelected([&](TileList selected) {
+            for (auto tile : selected) {
+                tile.setColor(TileColor::Gray);
+                if (not tile.isVisible())
+                    tile.setOrientation(Orientation::Blank);
+                tile.start_enabling(now);
+            }
+        });
         freezeSelection = true;
-        redrawFramebuffer = true;
         break;
     case 'c':
     case 'C':
-        for (auto *tile : selectedTiles)
-            if (tile->isVisible())
-                tile->orientation = Orientation::Blank;
+        editSelected([](TileList selected) {
+            for (auto tile : selected)
+                if (tile.isVisible())
+                    tile.setOrientation(Orientation::Blank);
+        });
         freezeSelection = true;
-        redrawFramebuffer = true;
         break;
     case 'D':
     case 'd':
     case OF_KEY_DEL:
         if (not shift()) {
-            for (auto *tile : selectedTiles) {
-                tile->start_disabling(now);
-            }
+            editSelected([&now](TileList selected) {
+                for (auto tile : selected) {
+                    tile.start_disabling(now);
+                }
+            });
         } else {
-            for (auto &tile : tiles) {
-                tile.start_disabling(now);
-            }
+            history.editFloor(tv, now, EditHistory::Bulk::Disable);
         }
         freezeSelection = true;
-        redrawFramebuffer = true;
         break;
     case 'r':
     case 'R':
         if (not ctrl_or_alt()) {
-            if (not shift()) {
-                for (auto &tile : tiles)
-                    if (tile.isVisible())
-                        tile.changeColorUp(now);
-            } else {
-                for (auto &tile : tiles)
-                    if (tile.isVisible())
-                        tile.changeColorDown(now);
-            }
-            redrawFramebuffer = true;
+            if (not shift())
+                history.editFloor(tv, now, EditHistory::Bulk::ColorUp);
+            else
+                history.editFloor(tv, now, EditHistory::Bulk::ColorDown);
             break;
         } else {
-            if (not shift()) {
-                for (auto *tile : selectedTiles)
-                    tile->changeToRandomColor(now);
-            } else {
-                for (auto &tile : selectedTiles) {
-                   tile->changeToRandomOrientation();
+            const auto random = tv.nextRandom();
+            editSelected([&](TileList selected) {
+                if (not shift()) {
+                    for (auto tile : selected)
+                        tile.changeToRandomColor(now, random);
+                } else {
+                    for (auto tile : selected) {
+                       tile.changeToRandomOrientation(random);
+                    }
                 }
-            }
+            });
             freezeSelection = true;
-            redrawFramebuffer = true;
             break;
         }
     case 'O':
     case 'o':
         if (not ctrl_or_alt()) {
-            if (not shift()) {
-                for (auto &tile : tiles)
-                    if (tile.isVisible() and tile.orientation != Orientation::Blank)
-                        tile.changeOrientationUp();
-            } else {
-                for (auto &tile : tiles)
-                    if (tile.isVisible() and tile.orientation != Orientation::Blank)
-                        tile.changeOrientationDown();
-            }
+            // up and down are the same for a tile that has an orientation
+            history.editFloor(tv, now, EditHistory::Bulk::FlipOrientation);
             break;
         } else {
-            if (not shift()) {
-                for (auto *tile : selectedTiles)
-                    tile->changeToRandomOrientation();
-            } else {
-                for (auto *tile : selectedTiles)
-                    tile->changeToRandomNonBlankOrientation();
-            }
+            const auto random = tv.nextRandom();
+            editSelected([&](TileList selected) {
+                if (not shift()) {
+                    for (auto tile : selected)
+                        tile.changeToRandomOrientation(random);
+                } else {
+                    for (auto tile : selected)
+                        tile.changeToRandomNonBlankOrientation(random);
+                }
+            });
             freezeSelection = true;
-            redrawFramebuffer = true;
             break;
         }
     case 'f':
@@ -544,11 +720,70 @@ void ofApp::keyPressed(int key)
         if (sticky.direction >= 0)
         (sticky.direction+= 5) %= 6;
         break;
+    case OF_KEY_F2:
+        saveFloor();
+        break;
+    case OF_KEY_F3: {
+        auto result = ofSystemLoadDialog("Open floor design");
+        if (result.bSuccess)
+            openFloor(result.getPath());
+        break;
+    }
+    case OF_KEY_F4:
+        saveFrameTimes();
+        break;
+    case 'M':
+    case 'm':
+        selectTool = selectTool != SelectTool::Rectangle ? SelectTool::Rectangle : SelectTool::None;
+        selecting = false;
+        break;
+    case 'L':
+    case 'l':
+        selectTool = selectTool != SelectTool::Lasso ? SelectTool::Lasso : SelectTool::None;
+        selecting = false;
+        break;
+    case OF_KEY_ESC:
+        selectTool = SelectTool::None;
+        selecting = false;
+        tv.clearRegion();
+        break;
     case 'Q':
     case 'q':
         if (ofGetKeyPressed(OF_KEY_ALT))
             ofExit(0);
         break;
+    case KEY_CTRL_('Z'):
+    case 'Z':
+    case 'z':
+        if (key == KEY_CTRL_('Z') or ctrl_or_alt()) {
+            if (not shift())
+                history.undo(tv, now);
+            else
+                history.redo(tv, now);
+        }
+        break;
+    case KEY_CTRL_('N'):
+    case 'N':
+    case 'n':
+        // with shift, the new floor is covered with tumbling blocks
+        if (key == KEY_CTRL_('N') or ctrl_or_alt())
+            newFloor(shift() ? FloorPattern::TumblingBlocks : FloorPattern::None);
+        break;
+    case KEY_CTRL_('V'):
+    case 'V':
+    case 'v':
+        // with shift, nine times as many walkers
+        if (key == KEY_CTRL_('V') or ctrl_or_alt())
+            crowd.clear();
+        else
+            crowd.populate(tv, CROWD_STEP * (size_t) step_multiplier(), (unsigned) now.time_since_epoch().count());
+        break;
+    case KEY_CTRL_('Y'):
+    case 'Y':
+    case 'y':
+        if (key == KEY_CTRL_('Y') or ctrl_or_alt())
+            history.redo(tv, now);
+        break;
     }
 
 #if defined(_DEBUG)
@@ -559,6 +794,7 @@ void ofApp::keyPressed(int key)
 //--------------------------------------------------------------
 void ofApp::keyReleased(int key)
 {
+    frameScheduler.wake(Clock::now());
     switch (key) {
     case OF_KEY_CONTROL:
     case OF_KEY_ALT:
@@ -576,8 +812,8 @@ void ofApp::updateSticky(int x, int y)
 {
     sticky.pos = ofVec2f { (float) (x), (float) (y) } / tv.view.zoom + tv.view.offset;
     if (sticky.visible or sticky.show_arrow) {
-        if (tv.currentTile != nullptr) {
-            sticky.adjustDirection(*tv.currentTile);
+        if (tv.currentTile != NO_TILE) {
+            sticky.adjustDirection(tv.tile(tv.currentTile));
         }
     }
 }
@@ -586,6 +822,7 @@ void ofApp::updateSticky(int x, int y)
 //--------------------------------------------------------------
 void ofApp::mouseMoved(int x, int y)
 {
+    frameScheduler.wake(Clock::now());
     tv.findCurrentTile(x, y);
     updateSticky(x, y);
 }
@@ -593,8 +830,16 @@ void ofApp::mouseMoved(int x, int y)
 //--------------------------------------------------------------
 void ofApp::mouseDragged(int x, int y, int button)
 {
+    frameScheduler.wake(Clock::now());
+    if (selecting) {
+        const auto point = viewPoint(x, y);
+        if (selectTool == SelectTool::Rectangle)
+            selectOutline.back() = point;
+        else if (selectOutline.back().distance(point) * tv.view.zoom >= LASSO_STEP_PIX)
+            selectOutline.push_back(point);
+        return;
+    }
     auto &currentTile = tv.currentTile;
-    const auto &selectedTiles = tv.selectedTiles;
     const auto &enableFlood = tv.enableFlood;
     auto &freezeSelection = tv.freezeSelection;
 
@@ -604,41 +849,46 @@ void ofApp::mouseDragged(int x, int y, int button)
     if (not enableFlood) {
         switch (button) {
         case OF_MOUSE_BUTTON_LEFT:
-            if (   prevTile != nullptr
+            if (   prevTile != NO_TILE
                and prevTile != currentTile
-               and currentTile != nullptr
-               and prevTile->enabled
+               and currentTile != NO_TILE
+               and tv.tile(prevTile).enabled()
                ) {
-                currentTile->color = prevTile->color;
-                if (not currentTile->enabled) {
-                    currentTile->orientation = prevTile->orientation;
-                    currentTile->start_enabling(Clock::now());
+                const auto from = tv.tile(prevTile);
+                auto to = tv.tile(currentTile);
+                history.begin(tv.tiles, { currentTile });
+                to.setColor(from.color());
+                if (not to.enabled()) {
+                    to.setOrientation(from.orientation());
+                    to.start_enabling(Clock::now());
                 }
-                redrawFramebuffer = true;
+                history.end(tv.tiles);
             }
             break;
         case OF_MOUSE_BUTTON_RIGHT:
-            if (   currentTile != nullptr 
+            if (   currentTile != NO_TILE
                 and currentTile != prevTile
-                and currentTile->enabled
+                and tv.tile(currentTile).enabled()
             ) {
-                currentTile->start_disabling(Clock::now());
-                redrawFramebuffer = true;
+                history.begin(tv.tiles, { currentTile });
+                tv.tile(currentTile).start_disabling(Clock::now());
+                history.end(tv.tiles);
             }
             break;
         }
     } else {
         switch (button) {
         case OF_MOUSE_BUTTON_RIGHT:
-            if (currentTile != nullptr
-                and currentTile->enabled
+            if (currentTile != NO_TILE
+                and tv.tile(currentTile).enabled()
                 ) {
                 const auto now = Clock::now();
-                for (auto *tile : selectedTiles) {
-                    tile->start_disabling(now);
-                }
+                editSelected([&now](TileList selected) {
+                    for (auto tile : selected) {
+                        tile.start_disabling(now);
+                    }
+                });
                 freezeSelection = false;
-                redrawFramebuffer = true;
             }
             break;
         }
@@ -649,37 +899,51 @@ void ofApp::mouseDragged(int x, int y, int button)
 //--------------------------------------------------------------
 void ofApp::mousePressed(int x, int y, int button)
 {
+    frameScheduler.wake(Clock::now());
+    if (selectTool != SelectTool::None and button == OF_MOUSE_BUTTON_LEFT) {
+        selecting = true;
+        selectOutline.assign(2, viewPoint(x, y));
+        if (selectTool == SelectTool::Lasso)
+            selectOutline.pop_back();
+        return;
+    }
+
     tv.findCurrentTile(x, y);
     tv.updateSelected();
 
-    auto &selectedTiles = tv.selectedTiles;
     auto &freezeSelection = tv.freezeSelection;
 
     auto now = Clock::now();
+    history.beginStroke();
     switch (button) {
         case OF_MOUSE_BUTTON_LEFT:
-            if (not shift())
-                for (auto *tile : selectedTiles)
-                    tile->changeColorUp(now);
-            else
-                for (auto *tile : selectedTiles)
-                    tile->changeColorDown(now);
-            redrawFramebuffer = true;
+            editSelected([&now](TileList selected) {
+                if (not shift())
+                    for (auto tile : selected)
+                        tile.changeColorUp(now);
+                else
+                    for (auto tile : selected)
+                        tile.changeColorDown(now);
+            });
             freezeSelection = true;
             tv.resetFocusStartTime();
             break;
         case OF_MOUSE_BUTTON_RIGHT:
-            for (auto *tile : selectedTiles) {
-                if (tile->enabled) {
-                    tile->start_disabling(now);
+            editSelected([&now](TileList selected) {
+                for (auto tile : selected) {
+                    if (tile.enabled()) {
+                        tile.start_disabling(now);
+                    }
                 }
-            }
+            });
             tv.resetFocusStartTime();
             freezeSelection = true;
             break;
         case OF_MOUSE_BUTTON_MIDDLE:
-            for (auto *tile : selectedTiles)
-                redrawFramebuffer |= tile->removeOrientation();
+            editSelected([](TileList selected) {
+                for (auto tile : selected)
+                    tile.removeOrientation();
+            });
             freezeSelection = true;
             tv.resetFocusStartTime();
             break;
@@ -689,20 +953,21 @@ void ofApp::mousePressed(int x, int y, int button)
 
 void ofApp::mouseScrolled(int x, int y, float scrollX, float scrollY)
 {
+    frameScheduler.wake(Clock::now());
     tv.findCurrentTile(x, y);
     tv.updateSelected();
 
-    for (auto * tile : tv.selectedTiles) {
-        if (tile->isVisible()) {
-            if (scrollY > 0)
-                tile->changeOrientationUp();
-
-            if (scrollY < 0)
-                tile->changeOrientationDown();
+    editSelected([scrollY](TileList selected) {
+        for (auto tile : selected) {
+            if (tile.isVisible()) {
+                if (scrollY > 0)
+                    tile.changeOrientationUp();
 
-            redrawFramebuffer = true;
+                if (scrollY < 0)
+                    tile.changeOrientationDown();
+            }
         }
-    }
+    });
     tv.freezeSelection = true;
     updateSticky(x, y);
 }
@@ -711,24 +976,54 @@ void ofApp::mouseScrolled(int x, int y, float scrollX, float scrollY)
 //--------------------------------------------------------------
 void ofApp::mouseReleased(int x, int y, int button)
 {
+    frameScheduler.wake(Clock::now());
+    if (selecting and button == OF_MOUSE_BUTTON_LEFT)
+        finishRegion();
+    history.endStroke();
+}
+
+ofVec2f ofApp::viewPoint(int x, int y) const
+{
+    return ofVec2f(x, y) / tv.view.zoom + tv.view.offset;
+}
 
+// a click without dragging clears the region
+void ofApp::finishRegion()
+{
+    selecting = false;
+    if (selectTool == SelectTool::Rectangle) {
+        const auto rect = spanned(selectOutline[0], selectOutline[1]);
+        if (rect.width * tv.view.zoom >= LASSO_STEP_PIX or rect.height * tv.view.zoom >= LASSO_STEP_PIX) {
+            tv.selectRegion(RegionSelection(rect));
+            return;
+        }
+    } else if (selectOutline.size() >= 3) {
+        tv.selectRegion(RegionSelection(std::move(selectOutline)));
+        selectOutline.clear();
+        return;
+    }
+    selectOutline.clear();
+    tv.clearRegion();
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseEntered(int x, int y)
 {
+    frameScheduler.wake(Clock::now());
     tv.findCurrentTile(x,y);
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseExited(int x, int y)
 {
-    tv.currentTile = nullptr;
+    frameScheduler.wake(Clock::now());
+    tv.currentTile = NO_TILE;
 }
 
 //--------------------------------------------------------------
 void ofApp::windowResized(int w, int h)
 {
+    frameScheduler.wake(Clock::now());
     resizeFrameBuffer(w, h);
 #ifdef _DEBUG
     clog << "window resized: w = " << w << "; h = " << h << endl;
@@ -745,12 +1040,16 @@ void ofApp::gotMessage(ofMessage msg)
 //--------------------------------------------------------------
 void ofApp::dragEvent(ofDragInfo dragInfo)
 {
-
+    frameScheduler.wake(Clock::now());
+    if (not dragInfo.files.empty())
+        openFloor(dragInfo.files.front());
 }
 
 float ofApp::getFocusAlpha(FloatSeconds period)
 {
-    auto diff = Clock::now() - focus_start;
+    // the pulse stops while idle
+    const auto now = frameScheduler.isIdle() ? frameScheduler.idleSince() : Clock::now();
+    auto diff = now - focus_start;
     auto elapsed_seconds = duration_cast<FloatSeconds>(diff);
     return -cosf(float(M_PI) * elapsed_seconds.count() / period.count()) / 2.f + .5f;
 }
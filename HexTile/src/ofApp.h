@@ -3,7 +3,15 @@
 #include "ofMain.h"
 
 #include "TileView.h"
-
+#include "TileBatch.h"
+#include "BackgroundLayer.h"
+#include "ChunkImages.h"
+#include "EditHistory.h"
+#include "FrameTimers.h"
+#include "FrameScheduler.h"
+#include "DirtyRegion.h"
+
+#include "Crowd.h"
 #include "Sticky.h"
 
 //#include <complex>
@@ -39,8 +47,7 @@ private:
     ofColor getFocusColor(int gray, float alpha);
     ofColor getFocusColorMix(ofColor alpha, ofColor beta, FloatSeconds period);
 
-    void drawBackground();
-    void drawShadows();
+    void drawTiles(const TileBatch &batch);
     void updateSticky() { updateSticky(ofGetMouseX(), ofGetMouseY()); }
     void updateSticky(int x, int y);
 
@@ -48,18 +55,61 @@ private:
     void drawSticky();
     void drawInfo();
     void drawFocus();
-    void drawTileFocus(Tile *tile, bool shift);
+    void drawTileFocus(Tile tile, bool shift);
+    void drawRegion();
+
+    ofVec2f viewPoint(int x, int y) const;
+    void finishRegion();
 
 
     void drawToFramebuffer();
+    void drawPendingTiles();
+    void collectDamage();
+    void drawDamageToFramebuffer();
 
     void resizeFrameBuffer(int w, int h);
 
+    // edit(TileList) on the selected tiles, a batch at a time, recorded as one command
+    template <typename F>
+    void editSelected(F edit)
+    {
+        history.beginGroup();
+        tv.forEachSelectedBatch([&](const std::vector<TileId> &ids) {
+            history.begin(tv.tiles, ids);
+            edit(TileList(tv.tiles, ids));
+            history.end(tv.tiles);
+        });
+        history.endGroup();
+    }
+
+    void openFloor(const std::string &path);
+    void newFloor(FloorPattern pattern);
+    void saveFloor();
+    void saveFrameTimes();
+
     ofFbo frameBuffer;
     bool redrawFramebuffer = false;
+    // veils the areas whose tiles are not created yet
+    ofMesh pendingMesh;
+
+    // tile edits and fades since the frame buffer was drawn
+    DirtyRegion damage;
+    std::uint64_t drawnEdits = 0;
+    TileBatch damageBatch;
+    std::vector<TileId> damagedTiles;
+
+    // drawn instead of the tiles when they are tiny
+    ChunkImages chunkImages;
+
+    EditHistory history;
+
+    FrameTimers frameTimers;
+    FrameScheduler frameScheduler;
 
     ofImage concrete;
+    BackgroundLayer background;
     TileImages tileImages;
+    TileBatch tileBatch;
 
     static const int default_zoom_level();
     int zoomLevel = default_zoom_level();
@@ -67,6 +117,19 @@ private:
 
     TileView tv;
     Sticky sticky;
+    Crowd crowd;
+
+    enum class SelectTool
+    {
+        None,
+        Rectangle,
+        Lasso,
+    };
+    // left dragging selects a region instead of painting
+    SelectTool selectTool = SelectTool::None;
+    bool selecting = false;
+    // the rectangle corners or the lasso drawn so far, in view coordinates
+    std::vector<ofVec2f> selectOutline;
 
 
     bool showInfo = true;
@@ -1,6 +1,9 @@
 #include <Windows.h>
 
-extern int main();
+#include <cstdio>
+#include <cstdlib>
+
+extern int main(int argc, char *argv[]);
 
 int CALLBACK WinMain(
 	_In_ HINSTANCE hInstance,
@@ -9,5 +12,10 @@ int CALLBACK WinMain(
 	_In_ int       nCmdShow
 )
 {
-	return main();
+	// the command line modes print to the console they were started from
+	if (__argc > 1 && AttachConsole(ATTACH_PARENT_PROCESS)) {
+		std::freopen("CONOUT$", "w", stdout);
+		std::freopen("CONOUT$", "w", stderr);
+	}
+	return main(__argc, __argv);
 }
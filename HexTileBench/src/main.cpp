@@ -0,0 +1,354 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: hpp
+ */
+
+// Headless benchmark of the TileView hot paths.
+// Every operation is run over a grid of viewport sizes, zoom levels and fill
+// patterns; each measurement is printed as one JSON object per line:
+//
+//   HexTileBench [--iterations N] [--pattern name] [--op name]
+//
+// The patterns are written into a temporary floor design and read back
+// through TileView::openFloor, so chunk paging is part of what is measured.
+
+#include "FloorFile.h"
+#include "TileChunk.h"
+#include "TileParams.h"
+#include "TileView.h"
+
+#include <ciso646>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const ofVec2f VIEWPORTS[] = { { 1024, 768 }, { 1920, 1080 }, { 3840, 2160 } };
+static const float ZOOMS[] = { 2, 1, 0.5f, 0.25f };
+static constexpr unsigned FIND_TILE_LOOKUPS = 100000;
+// views panned to the right by createMissingTiles, the floor designs reach that far
+static constexpr int MAX_ITERATIONS = 50;
+
+struct Pattern
+{
+    const char *name;
+    // nullptr for no tiles at all
+    std::function<bool(int row, int col, unsigned &color, unsigned &orientation)> tile;
+};
+
+static std::uint32_t hash(int row, int col)
+{
+    std::uint32_t h = std::uint32_t(row) * 0x9e3779b1u ^ std::uint32_t(col) * 0x85ebca77u;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+static const std::vector<Pattern> &patterns()
+{
+    static const std::vector<Pattern> patterns {
+        { "empty", nullptr },
+        { "full", [](int, int, unsigned &color, unsigned &orientation) {
+            color = 2;
+            orientation = 0;
+            return true;
+        } },
+        // half of the tiles, at random
+        { "scattered", [](int row, int col, unsigned &color, unsigned &orientation) {
+            const auto h = hash(row, col);
+            color = h % 3;
+            orientation = (h >> 8) % 3;
+            return (h >> 16 & 1) != 0;
+        } },
+        // large areas of one colour, the worst case of selectSimilarNeighbours
+        { "blocks", [](int row, int col, unsigned &color, unsigned &orientation) {
+            const auto h = hash(row >> 6, col >> 4);
+            color = h % 3;
+            orientation = 0;
+            return true;
+        } },
+    };
+    return patterns;
+}
+
+struct Result
+{
+    const char *op;
+    ofVec2f viewport;
+    float zoom;
+    const char *pattern;
+    unsigned opsPerIteration;
+    std::vector<double> ns;
+    size_t tiles;
+    size_t tileCapacity;
+};
+
+static size_t residentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters))
+        return counters.WorkingSetSize;
+    return 0;
+#elif defined(__linux__)
+    size_t pages = 0, resident = 0;
+    if (std::FILE *statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2)
+            resident = 0;
+        std::fclose(statm);
+    }
+    return resident * (size_t) sysconf(_SC_PAGESIZE);
+#else
+    // the peak, in bytes on macOS
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t) usage.ru_maxrss;
+#endif
+}
+
+static void print(Result &result)
+{
+    auto &ns = result.ns;
+    std::sort(ns.begin(), ns.end());
+    double sum = 0;
+    for (auto value : ns)
+        sum += value;
+    const double perOp = 1.0 / result.opsPerIteration;
+
+    std::ostringstream line;
+    line << "{\"op\":\"" << result.op << "\""
+         << ",\"width\":" << result.viewport.x
+         << ",\"height\":" << result.viewport.y
+         << ",\"zoom\":" << result.zoom
+         << ",\"pattern\":\"" << result.pattern << "\""
+         << ",\"iterations\":" << ns.size()
+         << ",\"ops_per_iteration\":" << result.opsPerIteration
+         << ",\"median_ns\":" << ns[ns.size() / 2] * perOp
+         << ",\"min_ns\":" << ns.front() * perOp
+         << ",\"max_ns\":" << ns.back() * perOp
+         << ",\"mean_ns\":" << sum / ns.size() * perOp
+         << ",\"tiles\":" << result.tiles
+         << ",\"tile_capacity\":" << result.tileCapacity
+         << ",\"rss_bytes\":" << residentBytes()
+         << "}";
+    std::cout << line.str() << std::endl;
+}
+
+template <typename F>
+static double measure(F f)
+{
+    const auto start = Clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// writes the pattern over every tile the benchmark views can reach
+static bool writePattern(const Pattern &pattern, const std::string &path)
+{
+    const auto widest = TileParams::tile_range(ofVec2f(3840, 2160), 0.25f);
+    const int rows = widest.rows.end - widest.rows.begin;
+    const int cols = widest.cols.end - widest.cols.begin;
+
+    const auto first = ChunkCoord::of(TileCoord { -2 * rows, -2 * cols });
+    const auto last = ChunkCoord::of(TileCoord { 3 * rows, (MAX_ITERATIONS + 3) * cols });
+
+    std::vector<ChunkData> data;
+    std::vector<ChunkCoord> coords;
+    for (int row = first.row; row <= last.row; ++row) {
+        for (int col = first.col; col <= last.col; ++col) {
+            const ChunkCoord chunk { row, col };
+            ChunkData bits {};
+            bool any = false;
+            for (unsigned slot = 0; slot < CHUNK_TILES; ++slot) {
+                const auto coord = chunk.tile(slot);
+                unsigned color, orientation;
+                if (pattern.tile(coord.row, coord.col, color, orientation)) {
+                    ChunkBits::set(bits.data(), slot, color, orientation, true);
+                    any = true;
+                }
+            }
+            if (any) {
+                data.push_back(bits);
+                coords.push_back(chunk);
+            }
+        }
+    }
+
+    std::vector<FloorFile::Chunk> chunks;
+    for (size_t i = 0; i < data.size(); ++i)
+        chunks.emplace_back(coords[i], data[i].data());
+    return FloorFile::write(path, chunks);
+}
+
+struct Bench
+{
+    ofVec2f viewport;
+    float zoom;
+    const Pattern *pattern;
+    std::string floorPath;
+    int iterations;
+    std::string only;
+
+    // a view of the pattern, far from the tiles until createTiles is called
+    void open(TileView &tv) const
+    {
+        tv.initView(ViewCoords(zoom, ofVec2f(-1e7f, -1e7f)), viewport);
+        if (pattern->tile)
+            tv.openFloor(floorPath);
+        tv.initView(ViewCoords(zoom, ofVec2f(0, 0)), viewport);
+        tv.removeExtraTiles(tv.view);
+    }
+
+    Result result(const char *op, unsigned opsPerIteration = 1) const
+    {
+        return Result { op, viewport, zoom, pattern->name, opsPerIteration, {}, 0, 0 };
+    }
+
+    bool wanted(const char *op) const
+    {
+        return only.empty() or only == op;
+    }
+
+    void finish(Result &result, const TileView &tv) const
+    {
+        result.tiles = tv.tiles.size();
+        result.tileCapacity = tv.tiles.capacity();
+        print(result);
+    }
+
+    void run() const
+    {
+        if (wanted("createTiles")) {
+            auto r = result("createTiles");
+            for (int i = 0; i < iterations; ++i) {
+                TileView tv;
+                open(tv);
+                r.ns.push_back(measure([&] { tv.createTiles(); }));
+                if (i + 1 == iterations)
+                    finish(r, tv);
+            }
+        }
+
+        TileView tv;
+        open(tv);
+        tv.createTiles();
+
+        if (wanted("createMissingTiles") or wanted("removeExtraTiles")) {
+            auto missing = result("createMissingTiles");
+            auto extra = result("removeExtraTiles");
+            for (int i = 0; i < iterations; ++i) {
+                tv.nextView = tv.view;
+                tv.nextView.offset.x += tv.view.getViewRect(viewport).width;
+                missing.ns.push_back(measure([&] { tv.createMissingTiles(tv.nextView); }));
+                tv.view = tv.nextView;
+                extra.ns.push_back(measure([&] { tv.removeExtraTiles(tv.view); }));
+            }
+            if (wanted("createMissingTiles"))
+                finish(missing, tv);
+            if (wanted("removeExtraTiles"))
+                finish(extra, tv);
+        }
+
+        if (wanted("findTile")) {
+            auto r = result("findTile", FIND_TILE_LOOKUPS);
+            std::mt19937 random(1);
+            std::uniform_real_distribution<float> x(0, viewport.x), y(0, viewport.y);
+            std::vector<ofVec2f> points(FIND_TILE_LOOKUPS);
+            for (auto &point : points)
+                point = ofVec2f(x(random), y(random));
+            size_t found = 0;
+            for (int i = 0; i < iterations; ++i) {
+                r.ns.push_back(measure([&] {
+                    for (const auto &point : points)
+                        found += tv.findTile(point.x, point.y) != NO_TILE;
+                }));
+            }
+            if (found == 0)
+                std::cerr << "findTile found nothing" << std::endl;
+            finish(r, tv);
+        }
+
+        if (wanted("selectSimilarNeighbours")) {
+            auto r = result("selectSimilarNeighbours");
+            const auto from = tv.findTile(viewport.x / 2, viewport.y / 2);
+            for (int i = 0; i < iterations; ++i) {
+                // the last selection would be reused
+                tv.floodSelection = false;
+                r.ns.push_back(measure([&] { tv.selectSimilarNeighbours(from); }));
+            }
+            finish(r, tv);
+        }
+
+        if (wanted("startZooming") or wanted("createPendingTiles")) {
+            auto start = result("startZooming");
+            // all the tiles queued by startZooming, without a budget
+            auto pending = result("createPendingTiles");
+            const auto center = viewport / 2;
+            for (int i = 0; i < iterations; ++i) {
+                const float to = i % 2 == 0 ? zoom / 2 : zoom;
+                start.ns.push_back(measure([&] { tv.startZooming(Clock::now(), 0s, to, center); }));
+                pending.ns.push_back(measure([&] { tv.createPendingTiles(Duration::max()); }));
+                tv.viewTrans.stop();
+                tv.view = tv.nextView;
+                tv.removeExtraTiles(tv.view);
+            }
+            if (wanted("startZooming"))
+                finish(start, tv);
+            if (wanted("createPendingTiles"))
+                finish(pending, tv);
+        }
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    int iterations = 20;
+    std::string onlyPattern, onlyOp;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        if (option == "--iterations")
+            iterations = std::min(std::max(std::atoi(argv[i + 1]), 1), MAX_ITERATIONS);
+        else if (option == "--pattern")
+            onlyPattern = argv[i + 1];
+        else if (option == "--op")
+            onlyOp = argv[i + 1];
+        else {
+            std::cerr << "usage: HexTileBench [--iterations N] [--pattern name] [--op name]" << std::endl;
+            return 2;
+        }
+    }
+
+    const std::string floorPath = "HexTileBench.hexfloor";
+    for (const auto &pattern : patterns()) {
+        if (not onlyPattern.empty() and onlyPattern != pattern.name)
+            continue;
+        if (pattern.tile and not writePattern(pattern, floorPath)) {
+            std::cerr << "cannot write " << floorPath << std::endl;
+            return 1;
+        }
+        for (const auto &viewport : VIEWPORTS)
+            for (auto zoom : ZOOMS)
+                Bench { viewport, zoom, &pattern, floorPath, iterations, onlyOp }.run();
+    }
+    std::remove(floorPath.c_str());
+    return 0;
+}